@@ -0,0 +1,124 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_CAPTURE_HPP
+#define OSSHS_PROTOCOL_CAPTURE_HPP
+
+#include <cstdint>
+#include <modm/platform.hpp>
+#include <osshs/protocol/utility/delegate.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace diagnostics
+		{
+			enum class CaptureRecordType : uint8_t
+			{
+				NONE = 0,
+				CAN_FRAME,     // Raw CAN frame, identifier holds the CAN identifier.
+				EVENT_PACKET,  // Serialized event packet, e.g. written to a USART.
+			};
+
+			/**
+			 * @brief Header of a captured frame or packet, followed by length bytes of data. Stored in target byte order.
+			 */
+			struct CaptureRecord
+			{
+				static constexpr uint8_t FLAG_TRANSMIT = (0b1 << 7);
+				static constexpr uint8_t FLAG_EXTENDED = (0b1 << 6);
+				static constexpr uint8_t CHANNEL_MASK = 0x0f;
+
+				uint64_t timestamp;
+				uint32_t identifier;
+				uint16_t length;
+				CaptureRecordType type;
+				uint8_t flags;  // Combination of flags and the channel, set by whoever stores the record.
+			};
+
+			static_assert(sizeof(CaptureRecord) == 16, "CaptureRecord layout must not depend on the compiler.");
+
+			/**
+			 * @brief Header preceding records in a capture file.
+			 */
+			struct CaptureFileHeader
+			{
+				static constexpr uint32_t MAGIC = 0x5043534f;  // "OSCP"
+				static constexpr uint16_t VERSION = 1;
+
+				uint32_t magic;
+				uint16_t version;
+				uint16_t recordSize;
+				uint32_t frequency;
+				uint32_t reserved;
+			};
+
+			static_assert(sizeof(CaptureFileHeader) == 16, "CaptureFileHeader layout must not depend on the compiler.");
+
+			typedef utility::Delegate<void (const CaptureRecord &record, const uint8_t *data)> CaptureCallback;
+
+			class Capture
+			{
+			public:
+				/**
+				 * @brief Hand a frame or packet to a capture callback, timestamped with the cycle counter.
+				 * @param callback capture callback, nothing is done if it is nullptr.
+				 * @param type record type.
+				 * @param flags combination of CaptureRecord flags.
+				 * @param identifier transport identifier or zero.
+				 * @param data frame or packet data.
+				 * @param length data length.
+				 */
+				static void
+				record(const CaptureCallback &callback, CaptureRecordType type, uint8_t flags, uint32_t identifier,
+					const uint8_t *data, uint16_t length);
+
+				/**
+				 * @brief Hand a CAN frame to a capture callback.
+				 * @param callback capture callback, nothing is done if it is nullptr.
+				 * @param frame captured frame.
+				 * @param transmitted whether the frame was transmitted or received.
+				 */
+				static void
+				recordCanFrame(const CaptureCallback &callback, const modm::can::Message &frame, bool transmitted)
+				{
+					if (callback == nullptr)
+						return;
+
+					record(
+						callback,
+						CaptureRecordType::CAN_FRAME,
+						(transmitted ? CaptureRecord::FLAG_TRANSMIT : 0) | (frame.isExtended() ? CaptureRecord::FLAG_EXTENDED : 0),
+						frame.getIdentifier(),
+						frame.data,
+						frame.getLength()
+					);
+				}
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_CAPTURE_HPP
@@ -0,0 +1,68 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_CYCLE_COUNTER_HPP
+#define OSSHS_PROTOCOL_CYCLE_COUNTER_HPP
+
+#include <cstdint>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace diagnostics
+		{
+			/**
+			 * @brief Free running timestamp source. Uses DWT CYCCNT on Cortex-M3 and up, the
+			 *        microsecond modm::PreciseClock on other MCUs and a steady clock on hosts.
+			 */
+			class CycleCounter
+			{
+			public:
+				/**
+				 * @brief Enable the cycle counter.
+				 */
+				static void
+				initialize();
+
+				/**
+				 * @brief Get current timestamp.
+				 * @note Timestamps wrap around, so only differences between them are meaningful.
+				 * @return Current timestamp in ticks.
+				 */
+				static uint32_t
+				now();
+
+				/**
+				 * @brief Get timestamp frequency.
+				 * @return Number of ticks per second.
+				 */
+				static uint32_t
+				getFrequency();
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_CYCLE_COUNTER_HPP
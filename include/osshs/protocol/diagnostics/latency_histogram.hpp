@@ -0,0 +1,206 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_LATENCY_HISTOGRAM_HPP
+#define OSSHS_PROTOCOL_LATENCY_HISTOGRAM_HPP
+
+#include <cstdint>
+#include <osshs/protocol/protocol_config.hpp>
+#include <osshs/protocol/diagnostics/cycle_counter.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace diagnostics
+		{
+			enum class LatencyStage : uint8_t
+			{
+				RX_CAPTURE = 0,
+				REASSEMBLED,
+				DISPATCHED,
+				TX_ENQUEUED,
+				TX_SENT,
+				COUNT
+			};
+
+			enum class LatencyInterval : uint8_t
+			{
+				REASSEMBLY = 0,  // RX_CAPTURE -> REASSEMBLED
+				DISPATCH,        // REASSEMBLED -> DISPATCHED
+				TRANSMIT,        // TX_ENQUEUED -> TX_SENT
+				FORWARD,         // RX_CAPTURE -> TX_SENT
+				COUNT
+			};
+
+			/**
+			 * @brief Timestamps taken at each stage a single packet went through.
+			 */
+			class LatencyTimestamps
+			{
+			public:
+				/**
+				 * @brief Set timestamp of a stage.
+				 * @param stage stage.
+				 * @param timestamp timestamp in CycleCounter ticks.
+				 */
+				void
+				set(LatencyStage stage, uint32_t timestamp);
+
+				/**
+				 * @brief Set timestamp of a stage to current time.
+				 * @param stage stage.
+				 */
+				void
+				mark(LatencyStage stage);
+
+				/**
+				 * @brief Check whether a stage was timestamped.
+				 * @param stage stage.
+				 * @return Whether or not the stage was timestamped.
+				 */
+				bool
+				has(LatencyStage stage) const;
+
+				/**
+				 * @brief Get timestamp of a stage.
+				 * @param stage stage.
+				 * @return Timestamp in CycleCounter ticks.
+				 */
+				uint32_t
+				get(LatencyStage stage) const;
+			private:
+				uint32_t timestamps[static_cast<uint8_t>(LatencyStage::COUNT)] = {};
+				uint8_t stageMask = 0;
+			};
+
+			/**
+			 * @brief Fixed-bucket log-scale histogram. Bucket n counts samples in range [2^(n-1), 2^n) ticks, bucket 0 counts zeros.
+			 */
+			class LatencyHistogram
+			{
+			public:
+				static constexpr uint8_t BUCKET_COUNT = 33;
+
+				/**
+				 * @brief Record a sample.
+				 * @param ticks sample in CycleCounter ticks.
+				 */
+				void
+				record(uint32_t ticks);
+
+				/**
+				 * @brief Get number of samples in a bucket.
+				 * @param bucket bucket index.
+				 * @return Number of samples.
+				 */
+				uint32_t
+				getBucket(uint8_t bucket) const;
+
+				/**
+				 * @brief Get total number of samples.
+				 * @return Number of samples.
+				 */
+				uint32_t
+				getCount() const;
+
+				/**
+				 * @brief Get largest recorded sample.
+				 * @return Largest sample in CycleCounter ticks.
+				 */
+				uint32_t
+				getMax() const;
+
+				/**
+				 * @brief Estimate a percentile from bucket upper bounds.
+				 * @param percentile percentile in range [0, 100].
+				 * @return Upper bound of the bucket containing the percentile in CycleCounter ticks.
+				 */
+				uint32_t
+				getPercentile(uint8_t percentile) const;
+			private:
+				uint32_t buckets[BUCKET_COUNT] = {};
+				uint32_t count = 0;
+				uint32_t max = 0;
+			};
+
+			/**
+			 * @brief Per-interface set of histograms, one per latency interval.
+			 */
+			class LatencyProfile
+			{
+			public:
+				/**
+				 * @brief Record receive side intervals of a packet.
+				 * @param timestamps packet timestamps.
+				 */
+				void
+				recordReceive(const LatencyTimestamps &timestamps);
+
+				/**
+				 * @brief Record transmit side intervals of a packet.
+				 * @param timestamps packet timestamps.
+				 */
+				void
+				recordTransmit(const LatencyTimestamps &timestamps);
+
+				/**
+				 * @brief Histogram getter.
+				 * @param interval latency interval.
+				 * @return Histogram of the interval.
+				 */
+				const LatencyHistogram &
+				getHistogram(LatencyInterval interval) const;
+			private:
+				LatencyHistogram histograms[static_cast<uint8_t>(LatencyInterval::COUNT)];
+
+				void
+				record(LatencyInterval interval, const LatencyTimestamps &timestamps, LatencyStage from, LatencyStage to);
+			};
+		}
+	}
+}
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+	#define OSSHS_PROTOCOL_LATENCY_CAPTURE(timestamp) \
+		const uint32_t timestamp = ::osshs::protocol::diagnostics::CycleCounter::now()
+	#define OSSHS_PROTOCOL_LATENCY_VALUE(timestamp) (timestamp)
+	#define OSSHS_PROTOCOL_LATENCY_SET(eventPacket, stage, timestamp) \
+		(eventPacket)->getLatencyTimestamps().set(::osshs::protocol::diagnostics::LatencyStage::stage, timestamp)
+	#define OSSHS_PROTOCOL_LATENCY_MARK(eventPacket, stage) \
+		(eventPacket)->getLatencyTimestamps().mark(::osshs::protocol::diagnostics::LatencyStage::stage)
+	#define OSSHS_PROTOCOL_LATENCY_RECORD_RECEIVE(interface, eventPacket) \
+		(interface)->latencyProfile.recordReceive((eventPacket)->getLatencyTimestamps())
+	#define OSSHS_PROTOCOL_LATENCY_RECORD_TRANSMIT(interface, eventPacket) \
+		(interface)->latencyProfile.recordTransmit((eventPacket)->getLatencyTimestamps())
+#else
+	#define OSSHS_PROTOCOL_LATENCY_CAPTURE(timestamp) ((void)0)
+	#define OSSHS_PROTOCOL_LATENCY_VALUE(timestamp) (0)
+	#define OSSHS_PROTOCOL_LATENCY_SET(eventPacket, stage, timestamp) ((void)0)
+	#define OSSHS_PROTOCOL_LATENCY_MARK(eventPacket, stage) ((void)0)
+	#define OSSHS_PROTOCOL_LATENCY_RECORD_RECEIVE(interface, eventPacket) ((void)0)
+	#define OSSHS_PROTOCOL_LATENCY_RECORD_TRANSMIT(interface, eventPacket) ((void)0)
+#endif
+
+#endif  // OSSHS_PROTOCOL_LATENCY_HISTOGRAM_HPP
@@ -0,0 +1,153 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_TRACE_HPP
+#define OSSHS_PROTOCOL_TRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <osshs/protocol/protocol_config.hpp>
+#include <osshs/protocol/diagnostics/cycle_counter.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace diagnostics
+		{
+			enum class TraceEventId : uint8_t
+			{
+				NONE = 0,
+				EVENT_REPORTED,              // InterfaceManager::reportEvent
+				EVENT_PACKET_DISPATCHED,     // InterfaceManager::reportEventPacket
+				EVENT_PACKET_ENQUEUED,       // Interface::reportEventPacket
+				CAN_EVENT_PACKET_READ,       // CanInterface::readEventPacket
+				CAN_EVENT_PACKET_WRITTEN,    // CanInterface::writeEventPacket
+				USART_EVENT_PACKET_WRITTEN,  // UsartInterface::writeEventPacket
+				EVENT_PACKET_MERGED,         // Interface::serializeEventPacket
+				USART_EVENT_PACKET_READ,     // UsartInterface::readFrame
+			};
+
+			/**
+			 * @brief Fixed-size trace record. Stored and dumped in target byte order.
+			 */
+			struct TraceRecord
+			{
+				static constexpr uint8_t FLAG_MULTI_TARGET = (0b1 << 7);
+				static constexpr uint8_t FLAG_COMMAND = (0b1 << 6);
+
+				uint32_t timestamp;
+				uint32_t transmitterMac;
+				uint32_t receiverMac;
+				uint16_t eventType;
+				uint16_t length;
+				TraceEventId eventId;
+				uint8_t flags;
+				uint16_t reserved;
+			};
+
+			static_assert(sizeof(TraceRecord) == 20, "TraceRecord layout must not depend on the compiler.");
+
+			/**
+			 * @brief Header preceding records in a trace dump.
+			 */
+			struct TraceDumpHeader
+			{
+				static constexpr uint32_t MAGIC = 0x5254534f;  // "OSTR"
+				static constexpr uint16_t VERSION = 1;
+
+				uint32_t magic;
+				uint16_t version;
+				uint16_t recordSize;
+				uint32_t frequency;
+				uint32_t recordCount;
+			};
+
+			static_assert(sizeof(TraceDumpHeader) == 16, "TraceDumpHeader layout must not depend on the compiler.");
+
+			/**
+			 * @brief Lock-free RAM ring of trace records. Oldest records are overwritten once the ring is full.
+			 */
+			class Trace
+			{
+			public:
+				static constexpr std::size_t BUFFER_SIZE = OSSHS_PROTOCOL_TRACE_BUFFER_SIZE;
+
+				static_assert((BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0, "Trace buffer size must be a power of two.");
+
+				/**
+				 * @brief Record a trace record.
+				 * @param eventId trace event id.
+				 * @param flags combination of TraceRecord flags.
+				 * @param transmitterMac transmitter mac.
+				 * @param receiverMac receiver mac.
+				 * @param eventType event type.
+				 * @param length serialized length or zero if unknown.
+				 */
+				static void
+				record(TraceEventId eventId, uint8_t flags, uint32_t transmitterMac, uint32_t receiverMac,
+					uint16_t eventType, uint16_t length = 0);
+
+				/**
+				 * @brief Dump the ring, oldest record first, preceded by a TraceDumpHeader.
+				 * @param buffer destination buffer.
+				 * @param bufferLength destination buffer length.
+				 * @return Number of bytes written.
+				 */
+				static std::size_t
+				dump(uint8_t *buffer, std::size_t bufferLength);
+
+				/**
+				 * @brief Discard all records.
+				 */
+				static void
+				clear();
+			private:
+				static TraceRecord records[BUFFER_SIZE];
+				static std::atomic<uint32_t> head;
+			};
+		}
+	}
+}
+
+#if OSSHS_PROTOCOL_TRACE
+	#define OSSHS_PROTOCOL_TRACE_EVENT_PACKET(eventId, eventPacket, length) \
+		::osshs::protocol::diagnostics::Trace::record( \
+			::osshs::protocol::diagnostics::TraceEventId::eventId, \
+			((eventPacket)->isMultiTarget() ? ::osshs::protocol::diagnostics::TraceRecord::FLAG_MULTI_TARGET : 0) | \
+				((eventPacket)->isCommand() ? ::osshs::protocol::diagnostics::TraceRecord::FLAG_COMMAND : 0), \
+			(eventPacket)->getTransmitterMac(), \
+			(eventPacket)->getReceiverMac(), \
+			(eventPacket)->getEventType(), \
+			length)
+	#define OSSHS_PROTOCOL_TRACE_EVENT(eventId, event) \
+		::osshs::protocol::diagnostics::Trace::record( \
+			::osshs::protocol::diagnostics::TraceEventId::eventId, 0, 0, 0, (event)->getType())
+#else
+	#define OSSHS_PROTOCOL_TRACE_EVENT_PACKET(eventId, eventPacket, length) ((void)0)
+	#define OSSHS_PROTOCOL_TRACE_EVENT(eventId, event) ((void)0)
+#endif
+
+#endif  // OSSHS_PROTOCOL_TRACE_HPP
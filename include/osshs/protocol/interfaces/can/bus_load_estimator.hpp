@@ -0,0 +1,122 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_BUS_LOAD_ESTIMATOR_HPP
+#define OSSHS_PROTOCOL_BUS_LOAD_ESTIMATOR_HPP
+
+#include <cstdint>
+#include <modm/platform.hpp>
+#include <osshs/protocol/protocol_config.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace can
+			{
+				/**
+				 * @brief Sliding window estimate of CAN bus utilisation from the frames seen on the bus.
+				 * @note The window is split into OSSHS_PROTOCOL_BUS_LOAD_SLOTS slots, the oldest slot is dropped as a whole.
+				 */
+				class BusLoadEstimator
+				{
+				public:
+					static constexpr uint8_t SLOT_COUNT = OSSHS_PROTOCOL_BUS_LOAD_SLOTS;
+					static constexpr uint32_t SLOT_DURATION = OSSHS_PROTOCOL_BUS_LOAD_WINDOW / OSSHS_PROTOCOL_BUS_LOAD_SLOTS;
+
+					static_assert(SLOT_DURATION > 0, "Bus load window must be at least one millisecond per slot.");
+
+					BusLoadEstimator();
+
+					/**
+					 * @brief Set the nominal bit rate of the bus.
+					 * @param bitRate bit rate in bits per second.
+					 */
+					void
+					setBitRate(uint32_t bitRate);
+
+					/**
+					 * @brief Set the congestion thresholds. Congestion is flagged above the high and cleared below the low one.
+					 * @param highPermille load in per mille at which the bus becomes congested.
+					 * @param lowPermille load in per mille at which the bus stops being congested.
+					 */
+					void
+					setCongestionThresholds(uint16_t highPermille, uint16_t lowPermille);
+
+					/**
+					 * @brief Account a frame sent or received on the bus.
+					 * @param dataLength frame data length code.
+					 * @param extended whether or not the frame has an extended identifier.
+					 */
+					void
+					recordFrame(uint8_t dataLength, bool extended = true);
+
+					/**
+					 * @brief Get the bus load over the sliding window.
+					 * @return Estimated bus utilisation in per mille.
+					 */
+					uint16_t
+					getLoad();
+
+					/**
+					 * @brief Check whether the bus is congested, with hysteresis between the congestion thresholds.
+					 * @return Whether or not the bus is congested.
+					 */
+					bool
+					isCongested();
+
+					/**
+					 * @brief Estimate the number of bits a frame occupies on the bus.
+					 * @param dataLength frame data length code.
+					 * @param extended whether or not the frame has an extended identifier.
+					 * @return Frame length in bits including an estimate of stuff bits and interframe space.
+					 */
+					static constexpr uint32_t
+					getFrameBits(uint8_t dataLength, bool extended = true)
+					{
+						// Fixed fields and interframe space come to 47 + 8n bits (67 + 8n extended), of which 34 + 8n (54 + 8n)
+						// are subject to bit stuffing. Worst case is one stuff bit per four of those, half of it is expected.
+						return (extended ? 67 : 47) + 8 * dataLength + ((extended ? 54 : 34) + 8 * dataLength - 1) / 8;
+					}
+				private:
+					uint32_t slotBits[SLOT_COUNT] = {};
+					uint32_t windowBits = 0;
+					uint8_t currentSlot = 0;
+					modm::Clock::time_point currentSlotStart;
+					uint32_t bitRate = OSSHS_PROTOCOL_CAN_BIT_RATE;
+					uint16_t highPermille = 700;
+					uint16_t lowPermille = 500;
+					bool congested = false;
+
+					void
+					advance();
+				};
+			}
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_BUS_LOAD_ESTIMATOR_HPP
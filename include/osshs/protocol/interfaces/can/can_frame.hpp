@@ -26,7 +26,8 @@
 #define OSSHS_PROTOCOL_CAN_FRAME_HPP
 
 #include <modm/platform.hpp>
-#include <memory>
+#include <cstdint>
+#include <osshs/protocol/interfaces/can/can_header.hpp>
 
 namespace osshs
 {
@@ -39,6 +40,8 @@ namespace osshs
 				class CanFrame
 				{
 				public:
+					static constexpr uint8_t MAX_DATA_LENGTH = 8;
+
 					/**
 					 * @brief Construct CAN frame from parameters and data.
 					 * @param data Up to 8 bytes of data (7 bytes if lastFrameId > 0).
@@ -59,10 +62,10 @@ namespace osshs
 
 					/**
 					 * @brief Convert frame to a modm CAN message.
-					 * @return Pointer to converted message.
+					 * @return Converted message.
 					 */
-					std::unique_ptr<modm::can::Message>
-					getMessage();
+					modm::can::Message
+					getMessage() const;
 
 					/**
 					 * @brief Get pointer to data.
@@ -94,7 +97,8 @@ namespace osshs
 
 					/**
 					 * @brief Get current or last frame id.
-					 * @note Returns last frame id if current frame id is zero, otherwise returns current frame id.
+					 * @note Returns last frame id if current frame id is zero, otherwise returns current frame id. Single frame
+					 *       packets have neither, so zero is returned.
 					 * @return Current or last frame id.
 					 */
 					uint16_t
@@ -114,9 +118,9 @@ namespace osshs
 					bool
 					isMultiFrame();
 				private:
-					std::unique_ptr<const uint8_t[]> data;
+					uint8_t data[MAX_DATA_LENGTH];
 					uint8_t dataLen;
-					uint16_t extendedIdentifier;
+					uint32_t extendedIdentifier;
 				};
 			}
 		}
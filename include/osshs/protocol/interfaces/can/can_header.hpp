@@ -0,0 +1,165 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_CAN_HEADER_HPP
+#define OSSHS_PROTOCOL_CAN_HEADER_HPP
+
+#include <cstdint>
+#include <osshs/protocol/utility/bit_field.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace can
+			{
+				/**
+				 * @brief Layout of the extended CAN identifier, see docs/CAN.md.
+				 */
+				struct CanIdentifier
+				{
+					typedef utility::BitField<uint32_t, 0, 16> TransmitterMac;
+					typedef utility::BitField<uint32_t, 16, 4> FrameIdHigh;
+					typedef utility::BitField<uint32_t, 26, 1> MultiFrameFlag;
+					typedef utility::BitField<uint32_t, 27, 1> StartFrameFlag;
+					typedef utility::BitField<uint32_t, 28, 1> NotErrorFlag;
+
+					/**
+					 * @brief Encode an extended CAN identifier.
+					 * @param transmitterMac transmitter device mac address.
+					 * @param multiFrame whether or not the frame is part of a multi frame packet.
+					 * @param start whether or not the frame is the first frame of a packet.
+					 * @param frameId frame count of first frames, frame id of successive frames.
+					 * @param error whether or not the frame is an error frame.
+					 * @return Extended CAN identifier.
+					 */
+					static constexpr uint32_t
+					encode(uint16_t transmitterMac, bool multiFrame, bool start, uint16_t frameId, bool error = false)
+					{
+						uint32_t identifier = TransmitterMac::set(0, transmitterMac);
+						identifier = FrameIdHigh::set(identifier, frameId >> 8);
+						identifier = MultiFrameFlag::set(identifier, multiFrame);
+						identifier = StartFrameFlag::set(identifier, start);
+						return NotErrorFlag::set(identifier, !error);
+					}
+
+					/**
+					 * @brief Get the frame id of a multi frame packet frame.
+					 * @param identifier extended CAN identifier.
+					 * @param data frame data, at least 1 byte.
+					 * @return Frame count of first frames, frame id of successive frames.
+					 */
+					static constexpr uint16_t
+					getFrameId(uint32_t identifier, const uint8_t *data)
+					{
+						return (FrameIdHigh::get(identifier) << 8) | data[0];
+					}
+				};
+
+				/**
+				 * @brief Fragment header policy of CAN frames, see docs/CAN.md.
+				 * @note Flags and the most significant nibble of the frame number live in the extended identifier,
+				 *       the least significant byte of the frame number is the first data byte of multi frame packets.
+				 */
+				struct CanHeader
+				{
+					static constexpr uint8_t IN_BAND_LENGTH = 1;
+					static constexpr bool ALWAYS_IN_BAND = false;
+
+					static void
+					write(uint32_t &identifier, uint8_t *data, bool multiFragment, bool first, uint16_t number, uint8_t)
+					{
+						identifier = CanIdentifier::encode(CanIdentifier::TransmitterMac::get(identifier), multiFragment, first, number);
+
+						if (multiFragment)
+							data[0] = number & 0xff;
+					}
+
+					static bool
+					isMultiFragment(uint32_t identifier, const uint8_t *)
+					{
+						return CanIdentifier::MultiFrameFlag::get(identifier);
+					}
+
+					static bool
+					isFirst(uint32_t identifier, const uint8_t *)
+					{
+						return CanIdentifier::StartFrameFlag::get(identifier);
+					}
+
+					static uint16_t
+					getNumber(uint32_t identifier, const uint8_t *data)
+					{
+						if (!CanIdentifier::MultiFrameFlag::get(identifier))
+							return 1;
+
+						return CanIdentifier::getFrameId(identifier, data);
+					}
+				};
+
+				/**
+				 * @brief Fragment header policy of classic CAN frames.
+				 */
+				struct ClassicCanHeader : CanHeader
+				{
+					static constexpr uint8_t MTU = 8;
+
+					static constexpr uint8_t
+					getPaddedLength(uint8_t length)
+					{
+						return length;
+					}
+				};
+
+				/**
+				 * @brief Fragment header policy of CAN FD frames, same identifier layout with up to 64 data bytes.
+				 */
+				struct CanFdHeader : CanHeader
+				{
+					static constexpr uint8_t MTU = 64;
+
+					/**
+					 * @brief Round a length up to the next valid CAN FD data length.
+					 * @param length fragment length.
+					 * @return Data length code compatible length.
+					 */
+					static constexpr uint8_t
+					getPaddedLength(uint8_t length)
+					{
+						if (length <= 8)
+							return length;
+						if (length <= 24)
+							return (length + 3) & ~0x3;
+
+						return length <= 32 ? 32 : (length <= 48 ? 48 : 64);
+					}
+				};
+			}
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_CAN_HEADER_HPP
@@ -25,7 +25,17 @@
 #ifndef OSSHS_PROTOCOL_CAN_INTERFACE_HPP
 #define OSSHS_PROTOCOL_CAN_INTERFACE_HPP
 
+#include <chrono>
+#include <modm/platform.hpp>
+#include <modm/processing/timer.hpp>
+#include <osshs/protocol/memory/static_queue.hpp>
+#include <osshs/protocol/utility/delegate.hpp>
 #include <osshs/protocol/interfaces/interface.hpp>
+#include <osshs/protocol/interfaces/packet_buffer.hpp>
+#include <osshs/protocol/interfaces/fragmenter.hpp>
+#include <osshs/protocol/interfaces/reassembler.hpp>
+#include <osshs/protocol/interfaces/can/bus_load_estimator.hpp>
+#include <osshs/protocol/interfaces/can/can_header.hpp>
 
 namespace osshs
 {
@@ -35,32 +45,124 @@ namespace osshs
 		{
 			namespace can
 			{
+				typedef utility::Delegate<bool (const modm::can::Message &frame)> FrameForwarder;
+				typedef utility::Delegate<uint32_t (uint32_t identifier)> IdentifierRewriter;
+
 				template<typename CAN>
 				class CanInterface : public Interface, private modm::NestedResumable<1>
 				{
 				public:
+					/**
+					 * @brief Maximum time between two frames of a multi frame packet.
+					 */
+					static constexpr std::chrono::milliseconds REASSEMBLY_TIMEOUT = std::chrono::milliseconds(10);
+
 					CanInterface() = default;
+
+					/**
+					 * @brief Set the nominal bit rate of the bus, used to estimate bus load.
+					 * @param bitRate bit rate in bits per second.
+					 */
+					void
+					setBitRate(uint32_t bitRate);
+
+					/**
+					 * @brief Get the bus load, estimated from all frames sent and received over a sliding window.
+					 * @return Bus utilisation in per mille.
+					 */
+					uint16_t
+					getBusLoad();
+
+					/**
+					 * @brief Bus load estimator getter, e.g. to adjust congestion thresholds.
+					 * @return Bus load estimator of this interface.
+					 */
+					BusLoadEstimator &
+					getBusLoadEstimator();
+
+					/**
+					 * @brief Check whether the bus load is above the congestion threshold.
+					 * @return Whether or not the bus is congested.
+					 */
+					bool
+					isCongested() override;
+
+					/**
+					 * @brief Bridge every frame received on this interface straight to another CAN interface.
+					 * @note Frames are forwarded as they arrive and are neither reassembled nor delivered locally, so events
+					 *       crossing the bridge are not seen by this node or its other interfaces. Set up both directions
+					 *       to bridge both ways.
+					 * @param peer interface to forward frames to.
+					 * @param identifierRewriter rewrites identifiers of forwarded frames or nullptr to keep them.
+					 */
+					template<typename PeerCAN>
+					void
+					setCutThroughPeer(CanInterface<PeerCAN> &peer, IdentifierRewriter identifierRewriter = nullptr);
+
+					/**
+					 * @brief Stop bridging and return to reassembling received packets.
+					 */
+					void
+					clearCutThroughPeer();
 				protected:
 					bool
 					run();
+
+					bool
+					isReady() const;
 				private:
-					std::shared_ptr<EventPacket> currentEventPacket;
-					std::unique_ptr<const uint8_t[]> currentBuffer;
-					uint16_t currentBufferLength;
-					uint16_t currentFrameCount;
-					uint16_t currentFrameId;
+					bool busy = false;
+					BusLoadEstimator busLoadEstimator;
+					PacketRef currentEventPacket;
+					PacketBuffer currentBuffer;
+					Fragmenter<ClassicCanHeader::MTU, ClassicCanHeader> fragmenter;
+					Reassembler<ClassicCanHeader::MTU, OSSHS_PROTOCOL_REASSEMBLY_SLOTS, ClassicCanHeader> reassembler;
+
+					FrameForwarder cutThroughForwarder;
+					IdentifierRewriter cutThroughRewriter;
+					memory::StaticQueue<modm::can::Message, OSSHS_PROTOCOL_CUT_THROUGH_DEPTH> cutThroughFrames;
+					uint16_t cutThroughRemaining = 0;  // Frames of a forwarded multi frame packet still to come.
+					modm::ShortTimeout cutThroughTimeout;
 
 					void
 					initialize();
 
-					uint32_t
-					generateCurrentFrameIdentifier();
+					/**
+					 * @brief Queue a frame forwarded by a cut-through peer for transmission.
+					 * @param frame frame to transmit.
+					 * @return Whether or not the frame was queued.
+					 */
+					bool
+					acceptCutThroughFrame(const modm::can::Message &frame);
+
+					/**
+					 * @brief Check whether a forwarded multi frame packet is still being transmitted.
+					 * @note Own packets must not interleave with it, as receivers reassemble frames in order.
+					 * @return Whether or not own transmission has to wait.
+					 */
+					bool
+					isCutThroughActive() const;
+
+					modm::ResumableResult<void>
+					writeCutThroughFrames();
+
+					/**
+					 * @brief Drop partially received packets whose next frame did not arrive in time.
+					 */
+					void
+					expireReassembly();
 
 					modm::ResumableResult<void>
 					readEventPacket();
 
 					modm::ResumableResult<void>
-					writeEventPacket(std::shared_ptr<EventPacket> eventPacket);
+					writeEventPacket(const PacketRef &eventPacket);
+
+					template<typename... Interfaces>
+					friend class interfaces::StaticInterfaceManager;
+
+					template<typename PeerCAN>
+					friend class CanInterface;
 				};
 			}
 		}
@@ -25,8 +25,13 @@
 #ifndef OSSHS_PROTOCOL_CAN_INTERFACE_CONTROLLER_HPP
 #define OSSHS_PROTOCOL_CAN_INTERFACE_CONTROLLER_HPP
 
+#include <osshs/protocol/protocol_config.hpp>
+#include <osshs/protocol/memory/queue.hpp>
+#include <osshs/protocol/utility/delegate.hpp>
 #include <osshs/protocol/interfaces/can/can_frame.hpp>
 #include <osshs/protocol/interfaces/interface.hpp>
+#include <osshs/protocol/interfaces/interface_statistics.hpp>
+#include <osshs/protocol/diagnostics/capture.hpp>
 
 namespace osshs
 {
@@ -36,10 +41,10 @@ namespace osshs
 		{
 			namespace can
 			{
-				typedef std::function<void (std::unique_ptr<CanFrame>)> FrameReceivedCallback;
+				typedef utility::Delegate<void (const CanFrame &frame)> FrameReceivedCallback;
 
 				template<typename CAN>
-				class CanInterfaceController : private modm::NestedResumable<1>
+				class CanInterfaceController : public modm::pt::Protothread, private modm::NestedResumable<1>
 				{
 				public:
 					CanInterfaceController(FrameReceivedCallback frameReceivedCallback = nullptr)
@@ -50,14 +55,50 @@ namespace osshs
 					void
 					initialize();
 
-					void
-					transmitFrame(std::unique_ptr<CanFrame> frame);
+					/**
+					 * @brief Queue a frame for transmission.
+					 * @param frame frame to transmit.
+					 * @return Whether or not the frame was queued, false if the queue is full.
+					 */
+					bool
+					transmitFrame(const CanFrame &frame);
 
 					bool
 					run();
+
+					/**
+					 * @brief Statistics getter.
+					 * @return Runtime counters of this controller.
+					 */
+					const InterfaceStatistics &
+					getStatistics() const
+					{
+						return statistics;
+					}
+
+					/**
+					 * @brief Reset all runtime counters of this controller.
+					 */
+					void
+					resetStatistics()
+					{
+						statistics = InterfaceStatistics();
+					}
+
+					/**
+					 * @brief Capture every frame sent and received by this controller.
+					 * @param callback capture callback or nullptr to stop capturing.
+					 */
+					void
+					setCaptureCallback(diagnostics::CaptureCallback callback)
+					{
+						captureCallback = callback;
+					}
 				private:
+					InterfaceStatistics statistics;
 					FrameReceivedCallback frameReceivedCallback;
-					std::queue<std::unique_ptr<CanFrame>> outgoingFrames;
+					diagnostics::CaptureCallback captureCallback;
+					memory::Queue<CanFrame> outgoingFrames;
 
 					modm::ResumableResult<void>
 					readFrame();
@@ -53,10 +53,17 @@ namespace osshs
 				}
 
 				template<typename CAN>
-				void
-				CanInterfaceController<CAN>::transmitFrame(std::unique_ptr<CanFrame> frame)
+				bool
+				CanInterfaceController<CAN>::transmitFrame(const CanFrame &frame)
 				{
-					outgoingFrames.push(frame);
+					if (!memory::push(outgoingFrames, frame))
+					{
+						statistics.queueDrops++;
+						return false;
+					}
+
+					statistics.updateQueueHighWaterMark(outgoingFrames.size());
+					return true;
 				}
 
 				template<typename CAN>
@@ -95,9 +102,16 @@ namespace osshs
 
 					{
 						modm::can::Message frame;
-						if (CAN::getMessage(frame) && frameReceivedCallback != nullptr)
+						if (CAN::getMessage(frame))
 						{
-								frameReceivedCallback(std::unique_ptr<CanFrame>(new CanFrame(frame)));
+							statistics.framesIn++;
+							statistics.bytesIn += frame.getLength();
+							diagnostics::Capture::recordCanFrame(captureCallback, frame, false);
+
+							if (frameReceivedCallback != nullptr)
+							{
+								frameReceivedCallback(CanFrame(frame));
+							}
 						}
 						else
 						{
@@ -118,7 +132,20 @@ namespace osshs
 
 					RF_WAIT_UNTIL(ResourceLock<CAN>::tryLock());
 
-					CAN::sendMessage(outgoingFrames.front());
+					if (!CAN::isReadyToSend())
+						statistics.txMailboxStalls++;
+
+					RF_WAIT_UNTIL(CAN::isReadyToSend());
+
+					{
+						modm::can::Message message = outgoingFrames.front().getMessage();
+						CAN::sendMessage(message);
+
+						statistics.framesOut++;
+						statistics.bytesOut += message.getLength();
+						diagnostics::Capture::recordCanFrame(captureCallback, message, true);
+					}
+
 					outgoingFrames.pop();
 
 					ResourceLock<CAN>::unlock();
@@ -26,9 +26,11 @@
 	#error "Don't include this file directly, use 'can_interface.hpp' instead!"
 #endif
 
+#include <algorithm>
 #include <modm/platform.hpp>
+#include <modm/processing/timer.hpp>
 #include <osshs/resource_lock.hpp>
-#include <osshs/protocol/interfaces/interface_manager.hpp>
+#include <osshs/protocol/diagnostics/trace.hpp>
 #include <osshs/log/logger.hpp>
 
 namespace osshs
@@ -47,15 +49,22 @@ namespace osshs
 
 					do
 					{
-						PT_WAIT_UNTIL(CAN::isMessageAvailable() | !eventPacketQueue.empty());
+						PT_WAIT_UNTIL(CAN::isMessageAvailable() || !cutThroughFrames.empty() ||
+							(!isCutThroughActive() && isTransmitPending()));
+
+						busy = true;
 
 						if (CAN::isMessageAvailable())
 						{
 							PT_CALL(readEventPacket());
 						}
+						else if (!cutThroughFrames.empty())
+						{
+							PT_CALL(writeCutThroughFrames());
+						}
 						else
 						{
-							currentEventPacket = eventPacketQueue.front();
+							currentEventPacket = std::move(eventPacketQueue.front());
 							eventPacketQueue.pop();
 
 							PT_CALL(writeEventPacket(currentEventPacket));
@@ -63,6 +72,8 @@ namespace osshs
 							currentEventPacket.reset();
 						}
 
+						busy = false;
+
 						PT_YIELD();
 					}
 					while (true);
@@ -70,40 +81,149 @@ namespace osshs
 					PT_END();
 				}
 
+				template<typename CAN>
+				bool
+				CanInterface<CAN>::isReady() const
+				{
+					return busy || CAN::isMessageAvailable() || !cutThroughFrames.empty() ||
+						(!eventPacketQueue.empty() && !isEgressBlocked() && !isCutThroughActive());
+				}
+
+				template<typename CAN>
+				void
+				CanInterface<CAN>::setBitRate(uint32_t bitRate)
+				{
+					busLoadEstimator.setBitRate(bitRate);
+				}
+
+				template<typename CAN>
+				uint16_t
+				CanInterface<CAN>::getBusLoad()
+				{
+					return busLoadEstimator.getLoad();
+				}
+
+				template<typename CAN>
+				BusLoadEstimator &
+				CanInterface<CAN>::getBusLoadEstimator()
+				{
+					return busLoadEstimator;
+				}
+
+				template<typename CAN>
+				bool
+				CanInterface<CAN>::isCongested()
+				{
+					return busLoadEstimator.isCongested();
+				}
+
+				template<typename CAN>
+				template<typename PeerCAN>
+				void
+				CanInterface<CAN>::setCutThroughPeer(CanInterface<PeerCAN> &peer, IdentifierRewriter identifierRewriter)
+				{
+					cutThroughRewriter = identifierRewriter;
+					cutThroughForwarder = [&peer](const modm::can::Message &frame) {
+						return peer.acceptCutThroughFrame(frame);
+					};
+				}
+
+				template<typename CAN>
+				void
+				CanInterface<CAN>::clearCutThroughPeer()
+				{
+					cutThroughForwarder = nullptr;
+					cutThroughRewriter = nullptr;
+				}
+
+				template<typename CAN>
+				bool
+				CanInterface<CAN>::acceptCutThroughFrame(const modm::can::Message &frame)
+				{
+					if (!cutThroughFrames.push(frame))
+						return false;
+
+					signalReady();
+					return true;
+				}
+
+				template<typename CAN>
+				bool
+				CanInterface<CAN>::isCutThroughActive() const
+				{
+					return cutThroughRemaining > 0 && !cutThroughTimeout.isExpired();
+				}
+
+				template<typename CAN>
+				modm::ResumableResult<void>
+				CanInterface<CAN>::writeCutThroughFrames()
+				{
+					RF_BEGIN();
+
+					RF_WAIT_UNTIL(ResourceLock<CAN>::tryLock());
+
+					while (!cutThroughFrames.empty())
+					{
+						if (!CAN::isReadyToSend())
+							statistics.txMailboxStalls++;
+
+						RF_WAIT_UNTIL(CAN::isReadyToSend());
+
+						{
+							const modm::can::Message &frame = cutThroughFrames.front();
+							uint32_t identifier = frame.getIdentifier();
+
+							if (ClassicCanHeader::isMultiFragment(identifier, frame.data))
+							{
+								if (ClassicCanHeader::isFirst(identifier, frame.data))
+									cutThroughRemaining = ClassicCanHeader::getNumber(identifier, frame.data) - 1;
+								else if (cutThroughRemaining > 0)
+									cutThroughRemaining--;
+
+								cutThroughTimeout.restart(REASSEMBLY_TIMEOUT);
+							}
+
+							CAN::sendMessage(frame);
+							statistics.framesOut++;
+							busLoadEstimator.recordFrame(frame.getLength());
+							diagnostics::Capture::recordCanFrame(captureCallback, frame, true);
+
+							cutThroughFrames.pop();
+						}
+					}
+
+					ResourceLock<CAN>::unlock();
+
+					RF_END();
+				}
+
 				template<typename CAN>
 				void
 				CanInterface<CAN>::initialize()
 				{
 					OSSHS_LOG_INFO("Initializing CAN interface.");
 
+#if !defined(MODM_OS_HOSTED)
 					modm::platform::CanFilter::setFilter(
 						0,
 						modm::platform::CanFilter::FIFO0,
 						modm::platform::CanFilter::ExtendedIdentifier(0),
 						modm::platform::CanFilter::ExtendedFilterMask(0)
 					);
+#endif
 				}
 
 				template<typename CAN>
-				uint32_t
-				CanInterface<CAN>::generateCurrentFrameIdentifier()
+				void
+				CanInterface<CAN>::expireReassembly()
 				{
-					constexpr uint32_t temp_mac = 0x00000000;
-					uint32_t identifier = temp_mac & 0xffff;
-
-					identifier |= (0b1 << 28);
-					identifier |= currentFrameId ? (0b0 << 27) : (0b1 << 27);
-					identifier |= (currentFrameCount > 1) ? (0b1 << 26) : (0b0 << 26);
-					identifier |= (0b0 << 25);
-					identifier |= (0b0 << 24);
-					identifier |= (0b0 << 23);
-					identifier |= (0b0 << 22);
-					identifier |= (0b0 << 21);
-					identifier |= (0b0 << 20);
-
-					identifier |= (((currentFrameId ? currentFrameId : currentFrameCount) & 0xf00) << 8);
-
-					return identifier;
+					uint8_t expired = reassembler.expire(REASSEMBLY_TIMEOUT);
+
+					if (expired)
+					{
+						OSSHS_LOG_WARNING("Timed out waiting for frames of %u multi frame packets.", expired);
+						statistics.reassemblyTimeouts += expired;
+					}
 				}
 
 				template<typename CAN>
@@ -112,167 +232,157 @@ namespace osshs
 				{
 					RF_BEGIN();
 
-					OSSHS_LOG_DEBUG("Reading event packet.");
-
 					RF_WAIT_UNTIL(ResourceLock<CAN>::tryLock());
 
 					{
 						modm::can::Message frame;
-						if (CAN::getMessage(frame))
+						if (!CAN::getMessage(frame))
 						{
-							if (frame.getIdentifier() & (0b1 << 26))
-							{
-								uint16_t frameCount = (frame.getIdentifier() >> 8) & 0xf00;
-								frameCount |= frame.data[0];
-
-								uint16_t bufferLength = frame.data[1] | (frame.data[2] << 8);
-								uint8_t *buffer = new (std::nothrow) uint8_t[bufferLength];
-
-								if (buffer == nullptr)
-								{
-									OSSHS_LOG_ERROR("Failed to allocate memory for a buffer(bufferLength = %u).", bufferLength);
-									RF_RETURN();
-								}
-
-								for (uint16_t frameId = 0; frameId < frameCount; frameId++)
-								{
-									if (frameId)
-									{
-										while (!CAN::isMessageAvailable());
-										CAN::getMessage(frame);
-									}
-
-									std::copy(&frame.data[1], &frame.data[8], &buffer[frameId * 7]);
-								}
-
-								std::shared_ptr<EventPacket> eventPacket(new (std::nothrow) EventPacket(
-									std::unique_ptr<const uint8_t[]>(buffer),
-									&InterfaceManager::reportEvent
-								));
-
-								if (eventPacket == nullptr)
-								{
-									OSSHS_LOG_ERROR("Failed to allocate memory for an event packet.");
-									RF_RETURN();
-								}
-
-								if (eventPacket->isMalformed())
-								{
-									OSSHS_LOG_WARNING("Discarding malformed event packet.");
-									RF_RETURN();
-								}
-
-								InterfaceManager::reportEventPacket(eventPacket, this);
-							}
+							OSSHS_LOG_WARNING("Could not read CAN frame.");
+							ResourceLock<CAN>::unlock();
+							RF_RETURN();
+						}
+
+						OSSHS_PROTOCOL_LATENCY_CAPTURE(captureTimestamp);
+
+						statistics.framesIn++;
+						busLoadEstimator.recordFrame(frame.getLength());
+						diagnostics::Capture::recordCanFrame(captureCallback, frame, false);
+
+						if (cutThroughForwarder)
+						{
+							if (cutThroughRewriter)
+								frame.setIdentifier(cutThroughRewriter(frame.getIdentifier()));
+
+							if (cutThroughForwarder(frame))
+								statistics.framesForwarded++;
 							else
-							{
-								uint16_t bufferLength = frame.data[0] | (frame.data[1] << 8);
-								uint8_t *buffer = new (std::nothrow) uint8_t[bufferLength];
-
-								if (buffer == nullptr)
-								{
-									OSSHS_LOG_ERROR("Failed to allocate memory for a buffer(bufferLength = %u).", bufferLength);
-									RF_RETURN();
-								}
-
-								std::copy(&frame.data[0], &frame.data[bufferLength], &buffer[0]);
-
-								std::shared_ptr<EventPacket> eventPacket(new (std::nothrow) EventPacket(
-									std::unique_ptr<const uint8_t[]>(buffer),
-									&InterfaceManager::reportEvent
-								));
-
-								if (eventPacket == nullptr)
-								{
-									OSSHS_LOG_ERROR("Failed to allocate memory for an event packet.");
-									RF_RETURN();
-								}
-
-								if (eventPacket->isMalformed())
-								{
-									OSSHS_LOG_WARNING("Discarding malformed event packet.");
-									RF_RETURN();
-								}
-								
-								InterfaceManager::reportEventPacket(eventPacket, this);
-							}
+								statistics.forwardDrops++;
+
+							ResourceLock<CAN>::unlock();
+							RF_RETURN();
 						}
-						else
+
+						expireReassembly();
+
+						uint32_t identifier = frame.getIdentifier();
+						ReassemblyResult result = reassembler.push(
+							CanIdentifier::TransmitterMac::get(identifier),
+							identifier,
+							frame.data,
+							frame.getLength(),
+							OSSHS_PROTOCOL_LATENCY_VALUE(captureTimestamp)
+						);
+
+						ResourceLock<CAN>::unlock();
+
+						switch (result)
 						{
-							OSSHS_LOG_WARNING("Could not read CAN frame.");
+							case ReassemblyResult::INCOMPLETE:
+								RF_RETURN();
+							case ReassemblyResult::MALFORMED:
+							case ReassemblyResult::ORPHANED:
+								OSSHS_LOG_WARNING("Discarding malformed CAN frame.");
+								statistics.malformedDrops++;
+								RF_RETURN();
+							case ReassemblyResult::NO_MEMORY:
+								OSSHS_LOG_ERROR("Failed to allocate memory for a buffer.");
+								statistics.allocationFailures++;
+								RF_RETURN();
+							case ReassemblyResult::COMPLETE:
+								break;
 						}
-					}
 
-					ResourceLock<CAN>::unlock();
+						PacketBuffer &buffer = reassembler.getCompleted();
+
+						uint16_t bufferLength = buffer.getLength();
+
+						PacketRef eventPacket = EventPacket::make(
+							buffer.get(),
+							bufferLength,
+							getEventCallback()
+						);
+
+						buffer.release();
+
+						if (eventPacket == nullptr)
+						{
+							OSSHS_LOG_ERROR("Failed to allocate memory for an event packet.");
+							statistics.allocationFailures++;
+							RF_RETURN();
+						}
+
+						if (eventPacket->isMalformed())
+						{
+							OSSHS_LOG_WARNING("Discarding malformed event packet.");
+							statistics.malformedDrops++;
+							RF_RETURN();
+						}
+
+						OSSHS_PROTOCOL_LATENCY_SET(eventPacket, RX_CAPTURE, reassembler.getCompletedTimestamp());
+						OSSHS_PROTOCOL_LATENCY_MARK(eventPacket, REASSEMBLED);
+
+						statistics.packetsIn++;
+						statistics.bytesIn += bufferLength;
+
+						OSSHS_PROTOCOL_TRACE_EVENT_PACKET(CAN_EVENT_PACKET_READ, eventPacket, bufferLength);
+
+						routeEventPacket(eventPacket, bufferLength);
+					}
 
 					RF_END();
 				}
 
 				template<typename CAN>
 				modm::ResumableResult<void>
-				CanInterface<CAN>::writeEventPacket(std::shared_ptr<EventPacket> eventPacket)
+				CanInterface<CAN>::writeEventPacket(const PacketRef &eventPacket)
 				{
 					RF_BEGIN();
 
-					OSSHS_LOG_DEBUG(
-						"Writing event packet(multiTarget = %u, command = %u, transmitterMac = 0x%08x, receiverMac = 0x%08x, eventType = 0x%04x).",
-						eventPacket->isMultiTarget(),
-						eventPacket->isCommand(),
-						eventPacket->getTransmitterMac(),
-						eventPacket->getReceiverMac(),
-						eventPacket->getEvent()->getType()
-					);
-
 					RF_WAIT_UNTIL(ResourceLock<CAN>::tryLock());
 
-					currentBuffer = eventPacket->serialize();
-
-					if (currentBuffer == nullptr)
+					if (!serializeEventPacket(eventPacket, currentBuffer))
 					{
 						OSSHS_LOG_WARNING("Failed to serialize event packet.");
+						ResourceLock<CAN>::unlock();
 						RF_RETURN();
 					}
 
-					currentBufferLength = currentBuffer[0] | (currentBuffer[1] << 8);
-					if (!((currentBufferLength - 1) / 8))
-					{
-						currentFrameCount = 1;
-					}
-					else
-					{
-						currentFrameCount = 1 + ((currentBufferLength - 1) / 7);
-					}
-					currentFrameId = 0;
+					fragmenter.start(currentBuffer.get(), currentBuffer.getLength(), CanIdentifier::TransmitterMac::set(0, mac));
 
-					if (currentFrameCount == 1)
+					while (fragmenter.hasNext())
 					{
-						modm::can::Message frame(generateCurrentFrameIdentifier(), currentBufferLength);
-						frame.setExtended(true);
+						if (!CAN::isReadyToSend())
+							statistics.txMailboxStalls++;
 
-						std::copy(&currentBuffer[0], &currentBuffer[currentBufferLength], &frame.data[0]);
+						RF_WAIT_UNTIL(CAN::isReadyToSend());
 
-						CAN::sendMessage(frame);
-					}
-					else
-					{
-						for (; currentFrameId < currentFrameCount; currentFrameId++)
 						{
-							uint16_t len = 8;
-							if (currentFrameId == currentFrameCount - 1)
-							{
-								len = currentBufferLength - currentFrameId * 7 + 1;
-							}
+							modm::can::Message frame;
+							uint32_t identifier;
 
-							modm::can::Message frame(generateCurrentFrameIdentifier(), len);
+							frame.setLength(fragmenter.next(identifier, frame.data));
+							frame.setIdentifier(identifier);
 							frame.setExtended(true);
-							frame.data[0] = currentFrameId ? currentFrameId & 0xff : currentFrameCount & 0xff;
-
-							std::copy(&currentBuffer[0], &currentBuffer[currentFrameId * 7], &frame.data[1]);
 
 							CAN::sendMessage(frame);
+							statistics.framesOut++;
+							busLoadEstimator.recordFrame(frame.getLength());
+							diagnostics::Capture::recordCanFrame(captureCallback, frame, true);
 						}
 					}
 
+					statistics.packetsOut++;
+					statistics.bytesOut += currentBuffer.getLength();
+					egressShaper.consume(currentBuffer.getLength());
+
+					OSSHS_PROTOCOL_TRACE_EVENT_PACKET(CAN_EVENT_PACKET_WRITTEN, eventPacket, currentBuffer.getLength());
+
+					OSSHS_PROTOCOL_LATENCY_MARK(eventPacket, TX_SENT);
+					OSSHS_PROTOCOL_LATENCY_RECORD_TRANSMIT(this, eventPacket);
+
+					currentBuffer.release();
+
 					ResourceLock<CAN>::unlock();
 
 					RF_END();
@@ -26,7 +26,13 @@
 #define OSSHS_PROTOCOL_EVENT_PACKET_HPP
 
 #include <memory>
+#include <utility>
+#include <atomic>
 #include <osshs/events/event.hpp>
+#include <osshs/protocol/protocol_config.hpp>
+#include <osshs/protocol/diagnostics/latency_histogram.hpp>
+#include <osshs/protocol/memory/slab_allocator.hpp>
+#include <osshs/protocol/interfaces/packet_header.hpp>
 
 namespace osshs
 {
@@ -34,17 +40,63 @@ namespace osshs
 	{
 		namespace interfaces
 		{
+			class EventPacket;
+		}
+	}
+}
+
+#include <osshs/protocol/interfaces/packet_ref.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			typedef uint8_t *(*SerializationBufferProvider)(void *context, uint16_t packetLength);
+
 			class EventPacket
 			{
 			public:
 				static constexpr uint32_t NULL_MAC = static_cast<uint32_t>(-1);
 
+				/**
+				 * @brief Construct event packet from serialized data of a known length, e.g. received from a bus.
+				 * @note Data failing validation yields a malformed event packet. Every further event of a container
+				 *       packet is unpacked into an event packet of its own, see takeNext().
+				 * @param data serialized event packet.
+				 * @param length serialized event packet buffer length.
+				 * @param callback callback for underlying event.
+				 */
+				EventPacket(const uint8_t *data, uint16_t length, const events::EventCallback &callback = nullptr);
+
+				/**
+				 * @brief Construct event packet from the current event of a decoded event packet.
+				 * @param data serialized event packet.
+				 * @param fields header fields decoded from data, see PacketHeader::nextEvent().
+				 * @param callback callback for underlying event.
+				 */
+				EventPacket(const uint8_t *data, const PacketHeader::Fields &fields, const events::EventCallback &callback);
+
+				/**
+				 * @brief Construct event packet from serialized data, trusting the length it contains.
+				 * @param data serialized event packet.
+				 * @param callback callback for underlying event.
+				 */
+				EventPacket(const uint8_t *data, const events::EventCallback &callback = nullptr)
+					: EventPacket(data, PacketHeader::PacketLength::read(data), callback)
+				{
+				}
+
 				/**
 				 * @brief Construct event packet from serialized data.
 				 * @param data serialized event packet.
 				 * @param callback callback for underlying event.
 				 */
-				EventPacket(std::unique_ptr<const uint8_t[]> data, events::EventCallback callback = nullptr);
+				EventPacket(std::unique_ptr<const uint8_t[]> data, const events::EventCallback &callback = nullptr)
+					: EventPacket(data.get(), callback)
+				{
+				}
 
 				/**
 				 * @brief Construct event packet.
@@ -52,9 +104,12 @@ namespace osshs
 				 * @param transmitterMac transmitter mac.
 				 * @param receiverMac receiver mac or NULL_MAC if event packet is multi target.
 				 * @param command whether or not this event packet is a command.
+				 * @param requestId request id of a tracked command or of the response to one.
 				 */
-				EventPacket(std::shared_ptr<events::Event> event, uint32_t transmitterMac, uint32_t receiverMac = NULL_MAC, bool command = false)
-					: multiTarget(receiverMac == NULL_MAC), command(command), transmitterMac(transmitterMac), receiverMac(receiverMac), event(event)
+				EventPacket(std::shared_ptr<events::Event> event, uint32_t transmitterMac, uint32_t receiverMac = NULL_MAC, bool command = false,
+					uint16_t requestId = PacketHeader::NO_REQUEST_ID)
+					: multiTarget(receiverMac == NULL_MAC), command(command), transmitterMac(transmitterMac), receiverMac(receiverMac),
+					requestId(requestId), event(event)
 				{
 				}
 
@@ -86,6 +141,14 @@ namespace osshs
 				uint32_t
 				getReceiverMac() const;
 
+				/**
+				 * @brief Request id getter.
+				 * @return Request id of a tracked command or of the response to one, PacketHeader::NO_REQUEST_ID
+				 *         otherwise.
+				 */
+				uint16_t
+				getRequestId() const;
+
 				/**
 				 * @brief Event getter.
 				 * @return Event contained in this event packet.
@@ -93,6 +156,13 @@ namespace osshs
 				std::shared_ptr<events::Event>
 				getEvent() const;
 
+				/**
+				 * @brief Event type getter. Cheaper than getEvent() as the event is not shared.
+				 * @return Type of the event contained in this event packet.
+				 */
+				uint16_t
+				getEventType() const;
+
 				/**
 				 * @brief Check whether this event packet is malformed.
 				 * @return Whether or not this event packet is malformed.
@@ -100,20 +170,154 @@ namespace osshs
 				bool
 				isMalformed() const;
 
+				/**
+				 * @brief Check whether this event packet may share a container packet with another one.
+				 * @param other event packet to merge with.
+				 * @return Whether or not both event packets have the same transmitter, receiver and kind.
+				 */
+				bool
+				isMergeableWith(const EventPacket &other) const;
+
+				/**
+				 * @brief Detach the event packet unpacked from the next event of the same received container packet.
+				 * @return Next event packet or nullptr if this was the last one.
+				 */
+				PacketRef
+				takeNext();
+
 				/**
 				 * @brief Serialize this event packet.
 				 * @return Serialized event packet or nullptr if serialization failed.
 				 */
 				std::unique_ptr<const uint8_t[]>
 				serialize() const;
+
+				/**
+				 * @brief Serialize this event packet into a caller provided buffer.
+				 * @param buffer destination buffer.
+				 * @param bufferLength destination buffer length.
+				 * @return Serialized event packet length or zero if serialization failed.
+				 */
+				uint16_t
+				serialize(uint8_t *buffer, uint16_t bufferLength) const;
+
+				/**
+				 * @brief Serialize this event packet into a buffer obtained once its length is known.
+				 * @note Events of at least OSSHS_PROTOCOL_COMPRESSION_THRESHOLD bytes are compressed when that saves
+				 *       space, so the returned length may be shorter than the length the buffer was requested for.
+				 * @param bufferProvider provider returning a buffer of at least packetLength bytes or nullptr.
+				 * @param context opaque pointer passed to the provider.
+				 * @return Serialized event packet length or zero if serialization failed.
+				 */
+				uint16_t
+				serialize(SerializationBufferProvider bufferProvider, void *context) const;
+
+				/**
+				 * @brief Serialize a container packet carrying the events of this and mergeable event packets.
+				 * @note Container packets are never compressed. A single event is serialized as a regular event packet.
+				 * @param events serialized events, starting with the event of this event packet.
+				 * @param eventCount number of events, at most PacketHeader::MAX_CONTAINER_EVENTS.
+				 * @param bufferProvider provider returning a buffer of at least packetLength bytes or nullptr.
+				 * @param context opaque pointer passed to the provider.
+				 * @return Serialized container packet length or zero if serialization failed.
+				 */
+				uint16_t
+				serializeContainer(const std::unique_ptr<const uint8_t[]> *events, uint8_t eventCount,
+					SerializationBufferProvider bufferProvider, void *context) const;
+
+				/**
+				 * @brief Allocate an event packet from the slab pools.
+				 * @param args event packet constructor arguments.
+				 * @return Reference to the event packet or nullptr if allocation failed.
+				 */
+				template<typename... Args>
+				static PacketRef
+				make(Args&&... args);
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+				/**
+				 * @brief Latency timestamps getter.
+				 * @return Timestamps taken at each stage this event packet went through.
+				 */
+				diagnostics::LatencyTimestamps &
+				getLatencyTimestamps();
+#endif
 			private:
+#if OSSHS_PROTOCOL_ATOMIC_REFERENCE_COUNT
+				std::atomic<uint16_t> referenceCount{0};
+#else
+				uint16_t referenceCount = 0;
+#endif
+
 				bool multiTarget;
 				bool command;
 				uint32_t transmitterMac;
 				uint32_t receiverMac;
+				uint16_t requestId;
 				std::shared_ptr<events::Event> event;
+				PacketRef next;
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+				diagnostics::LatencyTimestamps latencyTimestamps;
+#endif
+
+				EventPacket(const EventPacket&) = delete;
+
+				EventPacket&
+				operator=(const EventPacket&) = delete;
+
+				void
+				writeHeader(uint8_t *buffer, uint16_t packetLength, bool compressed = false, bool container = false) const;
+
+				uint16_t
+				serializeEvent(const uint8_t *serializedEvent, SerializationBufferProvider bufferProvider, void *context) const;
+
+				void
+				decodeEvent(const uint8_t *data, const PacketHeader::Fields &fields, const events::EventCallback &callback);
+
+				static void
+				destroy(EventPacket *eventPacket);
+
+				friend PacketRef;
 			};
+
 		}
 	}
 }
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			inline void
+			PacketRef::acquire()
+			{
+				if (eventPacket != nullptr)
+					++eventPacket->referenceCount;
+			}
+
+			inline void
+			PacketRef::release()
+			{
+				if (eventPacket != nullptr && --eventPacket->referenceCount == 0)
+					EventPacket::destroy(eventPacket);
+			}
+
+			template<typename... Args>
+			PacketRef
+			EventPacket::make(Args&&... args)
+			{
+				void *block = memory::SlabAllocator::allocate(sizeof(EventPacket));
+
+				if (block == nullptr)
+					return PacketRef();
+
+				return PacketRef(new (block) EventPacket(std::forward<Args>(args)...));
+			}
+		}
+	}
+}
+
 #endif  // OSSHS_PROTOCOL_EVENT_PACKET_HPP
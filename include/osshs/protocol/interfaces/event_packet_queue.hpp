@@ -0,0 +1,179 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_EVENT_PACKET_QUEUE_HPP
+#define OSSHS_PROTOCOL_EVENT_PACKET_QUEUE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <osshs/protocol/protocol_config.hpp>
+#include <osshs/protocol/interfaces/event_packet.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			/**
+			 * @brief What a full event packet queue does with a new event packet. Commands are never dropped to make room.
+			 */
+			enum class DropPolicy : uint8_t
+			{
+				DROP_NEWEST,       // Reject the new event packet.
+				DROP_OLDEST,       // Drop the oldest event packet, e.g. for telemetry.
+				COALESCE_BY_TYPE,  // Replace a queued event packet of the same type and receiver, e.g. for state updates.
+			};
+
+			enum class QueueResult : uint8_t
+			{
+				QUEUED,
+				COALESCED,
+				DROPPED_OLDEST,
+				REJECTED,
+			};
+
+			/**
+			 * @brief Backpressure reported to event producers, ordered by severity.
+			 */
+			enum class Backpressure : uint8_t
+			{
+				NONE,        // Event was queued everywhere without loss.
+				CONGESTED,   // Event was queued, but some queue is filling up or had to drop or coalesce. Producers should throttle.
+				OVERLOADED,  // Event could not be queued on some interface or could not be allocated at all.
+			};
+
+			/**
+			 * @brief Combine two backpressure states.
+			 * @return The more severe of both states.
+			 */
+			inline Backpressure
+			worst(Backpressure a, Backpressure b)
+			{
+				return a > b ? a : b;
+			}
+
+			/**
+			 * @brief Bounded FIFO of event packets waiting for transmission with a QoS aware drop policy.
+			 */
+			class EventPacketQueue
+			{
+			public:
+				EventPacketQueue();
+
+				/**
+				 * @brief Change capacity and drop policy. Excess event packets are dropped, oldest first.
+				 * @param capacity maximum number of queued event packets, limited to OSSHS_PROTOCOL_QUEUE_DEPTH in the
+				 *        static memory profile.
+				 * @param dropPolicy what to do with new event packets while the queue is full.
+				 * @param coalescing whether or not a new event packet replaces a queued one of the same event type, source
+				 *        and receiver in place, even while the queue is not full.
+				 * @return Whether or not the capacity is valid.
+				 */
+				bool
+				configure(std::size_t capacity, DropPolicy dropPolicy, bool coalescing = false);
+
+				/**
+				 * @brief Append an event packet, applying the drop policy if the queue is full.
+				 * @param eventPacket event packet to append.
+				 * @return What happened to the event packet.
+				 */
+				QueueResult
+				push(PacketRef eventPacket);
+
+				/**
+				 * @brief Remove the oldest event packet. The queue must not be empty.
+				 */
+				void
+				pop();
+
+				/**
+				 * @brief Get the oldest event packet. The queue must not be empty.
+				 * @return Reference to the oldest event packet.
+				 */
+				PacketRef &
+				front();
+
+				const PacketRef &
+				front() const;
+
+				bool
+				empty() const;
+
+				std::size_t
+				size() const;
+
+				std::size_t
+				capacity() const;
+
+				/**
+				 * @brief Check whether the queue is filling up, i.e. at least three quarters full.
+				 * @return Whether or not producers should throttle.
+				 */
+				bool
+				isCongested() const;
+			private:
+#if OSSHS_PROTOCOL_STATIC_MEMORY
+				PacketRef slots[OSSHS_PROTOCOL_QUEUE_DEPTH];
+#else
+				std::vector<PacketRef> slots;
+#endif
+				std::size_t head = 0;
+				std::size_t count = 0;
+				std::size_t limit = OSSHS_PROTOCOL_QUEUE_DEPTH;
+				DropPolicy dropPolicy = DropPolicy::DROP_OLDEST;
+				bool coalescing = false;
+
+				PacketRef &
+				at(std::size_t index);
+
+				const PacketRef &
+				at(std::size_t index) const;
+
+				void
+				erase(std::size_t index);
+
+				bool
+				eraseOldestNonCommand();
+
+				/**
+				 * @brief Replace a queued event packet carrying the same state.
+				 * @param eventPacket replacement event packet, left untouched if nothing was replaced.
+				 * @param matchSource whether or not the transmitter has to match as well.
+				 * @return Whether or not a queued event packet was replaced.
+				 */
+				bool
+				replace(PacketRef &eventPacket, bool matchSource);
+
+				EventPacketQueue(const EventPacketQueue&) = delete;
+
+				EventPacketQueue&
+				operator=(const EventPacketQueue&) = delete;
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_EVENT_PACKET_QUEUE_HPP
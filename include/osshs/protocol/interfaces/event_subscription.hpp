@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_EVENT_SUBSCRIPTION_HPP
+#define OSSHS_PROTOCOL_EVENT_SUBSCRIPTION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <osshs/protocol/protocol_config.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			/**
+			 * @brief Compact set of event types an interface has consumers for.
+			 * @note Event types are hashed into a bitmap, so unrelated types may share a bit. A collision only ever lets an
+			 *       unwanted event through, a subscribed event is never rejected.
+			 */
+			class EventSubscription
+			{
+			public:
+				static constexpr std::size_t BIT_COUNT = OSSHS_PROTOCOL_SUBSCRIPTION_BITS;
+
+				static_assert(BIT_COUNT >= 32 && (BIT_COUNT & (BIT_COUNT - 1)) == 0, "Subscription bitmap size must be a power of two of at least 32.");
+
+				/**
+				 * @brief Subscribe to an event type. The first subscription ends subscribing to all event types.
+				 * @param eventType event type to subscribe to.
+				 */
+				void
+				subscribe(uint16_t eventType)
+				{
+					if (all)
+					{
+						clear();
+						all = false;
+					}
+
+					std::size_t bit = hash(eventType);
+					bits[bit / 32] |= (1UL << (bit % 32));
+				}
+
+				/**
+				 * @brief Subscribe to all event types. This is the default.
+				 */
+				void
+				subscribeAll()
+				{
+					all = true;
+				}
+
+				/**
+				 * @brief Drop all subscriptions, afterwards no multi target event packets are accepted.
+				 */
+				void
+				clear()
+				{
+					for (uint32_t &word : bits)
+						word = 0;
+
+					all = false;
+				}
+
+				/**
+				 * @brief Check whether an event type may be subscribed to.
+				 * @param eventType event type to check.
+				 * @return Whether or not events of this type should be delivered.
+				 */
+				bool
+				contains(uint16_t eventType) const
+				{
+					if (all)
+						return true;
+
+					std::size_t bit = hash(eventType);
+					return (bits[bit / 32] >> (bit % 32)) & 0b1;
+				}
+			private:
+				uint32_t bits[BIT_COUNT / 32] = {};
+				bool all = true;
+
+				static std::size_t
+				hash(uint16_t eventType)
+				{
+					// Fold the high byte in, as related event types tend to differ in their low byte only.
+					return (eventType ^ (eventType >> 8)) & (BIT_COUNT - 1);
+				}
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_EVENT_SUBSCRIPTION_HPP
@@ -0,0 +1,112 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_FRAGMENTER_HPP
+#define OSSHS_PROTOCOL_FRAGMENTER_HPP
+
+#include <cstdint>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			/**
+			 * @brief Splits a serialized event packet into transport fragments.
+			 * @note A header policy describes how a transport marks fragments, it provides:
+			 *       - IN_BAND_LENGTH, the number of header bytes at the start of a fragment carrying them.
+			 *       - ALWAYS_IN_BAND, whether or not single fragment packets carry the in-band header as well.
+			 *       - write(identifier, data, multiFragment, first, number, payloadLength), which marks a fragment.
+			 *         number is the fragment count for the first fragment and the fragment index otherwise.
+			 *       - isMultiFragment(), isFirst() and getNumber(), which read those marks back.
+			 *       - getPaddedLength(length), the smallest valid fragment length of at least length bytes.
+			 * @tparam MTU maximum fragment length in bytes.
+			 * @tparam HeaderPolicy header policy of the transport.
+			 */
+			template<uint8_t MTU, typename HeaderPolicy>
+			class Fragmenter
+			{
+			public:
+				static constexpr uint8_t PAYLOAD_LENGTH = MTU - HeaderPolicy::IN_BAND_LENGTH;
+
+				static_assert(MTU > HeaderPolicy::IN_BAND_LENGTH + 2, "Fragments must fit the in-band header and the packet length.");
+
+				/**
+				 * @brief Get the number of fragments a packet is split into.
+				 * @param packetLength serialized event packet length.
+				 * @return Number of fragments.
+				 */
+				static constexpr uint16_t
+				getFragmentCount(uint16_t packetLength)
+				{
+					if (!HeaderPolicy::ALWAYS_IN_BAND && packetLength <= MTU)
+						return 1;
+
+					return packetLength <= PAYLOAD_LENGTH ? 1 : (packetLength + PAYLOAD_LENGTH - 1) / PAYLOAD_LENGTH;
+				}
+
+				/**
+				 * @brief Start fragmenting a packet. The packet must stay valid until the last fragment is taken.
+				 * @param packet serialized event packet.
+				 * @param packetLength serialized event packet length.
+				 * @param identifier transport identifier bits shared by all fragments, e.g. the transmitter mac.
+				 */
+				void
+				start(const uint8_t *packet, uint16_t packetLength, uint32_t identifier = 0);
+
+				bool
+				hasNext() const
+				{
+					return fragmentIndex < fragmentCount;
+				}
+
+				uint16_t
+				getFragmentCount() const
+				{
+					return fragmentCount;
+				}
+
+				/**
+				 * @brief Write the next fragment. Only valid while hasNext().
+				 * @param identifier destination of the fragment's transport identifier.
+				 * @param data destination of the fragment, at least MTU bytes.
+				 * @return Fragment length in bytes.
+				 */
+				uint8_t
+				next(uint32_t &identifier, uint8_t *data);
+			private:
+				const uint8_t *packet = nullptr;
+				uint16_t packetLength = 0;
+				uint32_t baseIdentifier = 0;
+				uint16_t fragmentCount = 0;
+				uint16_t fragmentIndex = 0;
+			};
+		}
+	}
+}
+
+#include <osshs/protocol/interfaces/fragmenter_impl.hpp>
+
+#endif  // OSSHS_PROTOCOL_FRAGMENTER_HPP
@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_FRAGMENTER_HPP
+	#error "Don't include this file directly, use 'fragmenter.hpp' instead!"
+#endif
+
+#include <algorithm>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			template<uint8_t MTU, typename HeaderPolicy>
+			void
+			Fragmenter<MTU, HeaderPolicy>::start(const uint8_t *packet, uint16_t packetLength, uint32_t identifier)
+			{
+				this->packet = packet;
+				this->packetLength = packetLength;
+				baseIdentifier = identifier;
+				fragmentCount = getFragmentCount(packetLength);
+				fragmentIndex = 0;
+			}
+
+			template<uint8_t MTU, typename HeaderPolicy>
+			uint8_t
+			Fragmenter<MTU, HeaderPolicy>::next(uint32_t &identifier, uint8_t *data)
+			{
+				bool multiFragment = fragmentCount > 1;
+				bool first = fragmentIndex == 0;
+				uint16_t number = first ? fragmentCount : fragmentIndex;
+
+				uint8_t headerLength = 0;
+				uint16_t offset = 0;
+				uint8_t payloadLength = packetLength;
+
+				if (multiFragment || HeaderPolicy::ALWAYS_IN_BAND)
+				{
+					headerLength = HeaderPolicy::IN_BAND_LENGTH;
+					offset = fragmentIndex * PAYLOAD_LENGTH;
+					payloadLength = std::min<uint16_t>(PAYLOAD_LENGTH, packetLength - offset);
+				}
+
+				identifier = baseIdentifier;
+				HeaderPolicy::write(identifier, data, multiFragment, first, number, payloadLength);
+
+				std::copy(&packet[offset], &packet[offset + payloadLength], &data[headerLength]);
+
+				uint8_t length = headerLength + payloadLength;
+				uint8_t paddedLength = HeaderPolicy::getPaddedLength(length);
+				std::fill(&data[length], &data[paddedLength], 0);
+
+				fragmentIndex++;
+
+				return paddedLength;
+			}
+		}
+	}
+}
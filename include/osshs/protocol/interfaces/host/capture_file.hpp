@@ -0,0 +1,173 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_CAPTURE_FILE_HPP
+#define OSSHS_PROTOCOL_CAPTURE_FILE_HPP
+
+#if defined(__linux__)
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <osshs/protocol/diagnostics/capture.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				/**
+				 * @brief Appends captured frames and packets to a capture file.
+				 * @note Records are restamped with a 64 bit nanosecond clock, so capture gaps of any length replay
+				 *       faithfully. Safe to share between interfaces stepped on different threads.
+				 */
+				class CaptureWriter
+				{
+				public:
+					CaptureWriter() = default;
+
+					~CaptureWriter();
+
+					/**
+					 * @brief Create a capture file, replacing an existing one.
+					 * @param path capture file path.
+					 * @return Whether or not the file could be created.
+					 */
+					bool
+					open(const char *path);
+
+					void
+					close();
+
+					bool
+					isOpen() const;
+
+					/**
+					 * @brief Append a record.
+					 * @param record record header, its timestamp is replaced.
+					 * @param data record data.
+					 */
+					void
+					write(const diagnostics::CaptureRecord &record, const uint8_t *data);
+
+					/**
+					 * @brief Get a capture callback appending records of one channel, e.g. for Interface::setCaptureCallback().
+					 * @param channel channel stored with the records, up to CaptureRecord::CHANNEL_MASK.
+					 * @return Capture callback. The writer has to outlive it.
+					 */
+					diagnostics::CaptureCallback
+					getCallback(uint8_t channel);
+
+					/**
+					 * @brief Write buffered records to the file.
+					 * @return Whether or not all records were written.
+					 */
+					bool
+					flush();
+
+					/**
+					 * @brief Get the number of records appended since the file was created.
+					 * @return Number of records.
+					 */
+					uint64_t
+					getRecordCount() const;
+				private:
+					std::FILE *file = nullptr;
+					mutable std::mutex mutex;
+					std::chrono::steady_clock::time_point start;
+					uint64_t recordCount = 0;
+
+					CaptureWriter(const CaptureWriter&) = delete;
+
+					CaptureWriter&
+					operator=(const CaptureWriter&) = delete;
+				};
+
+				/**
+				 * @brief Read-only memory mapped capture file.
+				 */
+				class CaptureFile
+				{
+				public:
+					CaptureFile() = default;
+
+					~CaptureFile();
+
+					/**
+					 * @brief Map a capture file and check its header.
+					 * @param path capture file path.
+					 * @return Whether or not the file could be mapped and is a supported capture file.
+					 */
+					bool
+					open(const char *path);
+
+					void
+					close();
+
+					/**
+					 * @brief Get the timestamp frequency of the records.
+					 * @return Number of timestamp ticks per second.
+					 */
+					uint32_t
+					getFrequency() const;
+
+					/**
+					 * @brief Get the offset of the first record, where reading starts.
+					 * @return Offset in bytes.
+					 */
+					std::size_t
+					getFirstOffset() const;
+
+					/**
+					 * @brief Read a record.
+					 * @param offset offset of the record, advanced to the next one.
+					 * @param record record header destination.
+					 * @param data set to the mapped record data.
+					 * @return Whether or not a complete record was read, false at the end of the file or of a truncated one.
+					 */
+					bool
+					read(std::size_t &offset, diagnostics::CaptureRecord &record, const uint8_t *&data) const;
+				private:
+					const uint8_t *map = nullptr;
+					std::size_t size = 0;
+					diagnostics::CaptureFileHeader header;
+
+					CaptureFile(const CaptureFile&) = delete;
+
+					CaptureFile&
+					operator=(const CaptureFile&) = delete;
+				};
+			}
+		}
+	}
+}
+
+#endif  // __linux__
+
+#endif  // OSSHS_PROTOCOL_CAPTURE_FILE_HPP
@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_INTERFACE_WORKER_HPP
+#define OSSHS_PROTOCOL_INTERFACE_WORKER_HPP
+
+#include <osshs/protocol/protocol_config.hpp>
+
+#if OSSHS_PROTOCOL_THREADED
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <osshs/protocol/memory/mpsc_queue.hpp>
+#include <osshs/protocol/interfaces/event_packet.hpp>
+#include <osshs/protocol/interfaces/event_packet_queue.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			class Interface;
+
+			namespace host
+			{
+				/**
+				 * @brief Thread stepping a single interface.
+				 * @note Other threads never touch the interface directly, they post event packets to its inbox. The
+				 *       worker moves them to the interface queue, so queue policies, statistics and the medium are only
+				 *       ever accessed from one thread.
+				 */
+				class InterfaceWorker
+				{
+				public:
+					/**
+					 * @brief Longest time the worker sleeps without being signalled, so timeouts keep running.
+					 */
+					static constexpr std::chrono::milliseconds POLL_INTERVAL = std::chrono::milliseconds(1);
+
+					explicit InterfaceWorker(Interface &interface);
+
+					~InterfaceWorker();
+
+					void
+					start();
+
+					/**
+					 * @brief Stop the worker and wait for it to exit. Event packets still in the inbox are dropped.
+					 */
+					void
+					stop();
+
+					/**
+					 * @brief Hand an event packet to the interface. Safe to call from any thread.
+					 * @param eventPacket event packet to transmit.
+					 * @return Backpressure of the interface as last seen by the worker, OVERLOADED if the inbox is full.
+					 */
+					Backpressure
+					post(PacketRef eventPacket);
+
+					/**
+					 * @brief Wake the worker up. Safe to call from any thread.
+					 */
+					void
+					wake();
+				private:
+					Interface &interface;
+					memory::MpscQueue<PacketRef, OSSHS_PROTOCOL_INBOX_DEPTH> inbox;
+					std::atomic<uint32_t> inboxDrops{0};
+					std::atomic<Backpressure> backpressure{Backpressure::NONE};
+					std::atomic<bool> signalled{false};
+					std::atomic<bool> running{false};
+					std::mutex wakeMutex;
+					std::condition_variable wakeCondition;
+					std::thread thread;
+
+					void
+					loop();
+
+					void
+					drainInbox();
+
+					InterfaceWorker(const InterfaceWorker&) = delete;
+
+					InterfaceWorker&
+					operator=(const InterfaceWorker&) = delete;
+				};
+			}
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_THREADED
+
+#endif  // OSSHS_PROTOCOL_INTERFACE_WORKER_HPP
@@ -0,0 +1,140 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_REPLAY_INTERFACE_HPP
+#define OSSHS_PROTOCOL_REPLAY_INTERFACE_HPP
+
+#if defined(__linux__)
+
+#include <chrono>
+#include <cstdint>
+#include <osshs/protocol/protocol_config.hpp>
+#include <osshs/protocol/interfaces/reassembler.hpp>
+#include <osshs/protocol/interfaces/can/can_header.hpp>
+#include <osshs/protocol/interfaces/host/capture_file.hpp>
+#include <osshs/protocol/interfaces/host/virtual_interface.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				/**
+				 * @brief Counters of a replay.
+				 */
+				struct ReplayStatistics
+				{
+					uint64_t records = 0;       // Records read from the capture file.
+					uint64_t canFrames = 0;     // CAN frames fed to reassembly.
+					uint64_t eventPackets = 0;  // Event packets injected.
+					uint64_t bytes = 0;         // Serialized length of injected event packets.
+					uint64_t malformed = 0;     // Records or reassembled packets that did not make up an event packet.
+				};
+
+				/**
+				 * @brief Virtual interface receiving the traffic of a capture file.
+				 * @note Every record is replayed, transmitted and received ones alike, so the manager sees all traffic
+				 *       the capturing node saw. CAN frames are reassembled per channel and transmitter.
+				 */
+				class ReplayInterface : public VirtualInterface
+				{
+				public:
+					/**
+					 * @brief Maximum number of records replayed per step, so transmitting interfaces get to drain.
+					 */
+					static constexpr uint16_t BURST = 64;
+
+					/**
+					 * @brief Create a replay of a capture file.
+					 * @param captureFile opened capture file, it has to outlive the interface.
+					 */
+					ReplayInterface(const CaptureFile &captureFile);
+
+					/**
+					 * @brief Set the replay speed. Takes effect at the next rewind().
+					 * @param speed multiple of the captured speed, e.g. 1 for real time, or 0 to replay as fast as possible.
+					 */
+					void
+					setSpeed(double speed);
+
+					/**
+					 * @brief Restart the replay from the first record.
+					 */
+					void
+					rewind();
+
+					/**
+					 * @brief Check whether every record was replayed.
+					 * @return Whether or not the replay is over.
+					 */
+					bool
+					isFinished() const;
+
+					/**
+					 * @brief Replay statistics getter.
+					 * @return Counters of the replay so far.
+					 */
+					const ReplayStatistics &
+					getReplayStatistics() const;
+				protected:
+					bool
+					run() override;
+
+					bool
+					isReady() const override;
+				private:
+					const CaptureFile &captureFile;
+					std::size_t offset;
+					double speed = 1;
+					bool started = false;
+					uint64_t firstTimestamp = 0;
+					std::chrono::steady_clock::time_point startTime;
+					ReplayStatistics replayStatistics;
+					Reassembler<can::ClassicCanHeader::MTU, OSSHS_PROTOCOL_REASSEMBLY_SLOTS, can::ClassicCanHeader> reassembler;
+
+					/**
+					 * @brief Check whether a record is due at the current replay speed.
+					 * @param record record to check.
+					 * @return Whether or not the record should be replayed now.
+					 */
+					bool
+					isDue(const diagnostics::CaptureRecord &record) const;
+
+					void
+					replay(const diagnostics::CaptureRecord &record, const uint8_t *data);
+
+					void
+					inject(const uint8_t *data, uint16_t length);
+				};
+			}
+		}
+	}
+}
+
+#endif  // __linux__
+
+#endif  // OSSHS_PROTOCOL_REPLAY_INTERFACE_HPP
@@ -0,0 +1,197 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_SERIAL_PORT_HPP
+#define OSSHS_PROTOCOL_SERIAL_PORT_HPP
+
+#if defined(__linux__)
+
+#include <cstddef>
+#include <cstdint>
+#include <osshs/protocol/protocol_config.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				/**
+				 * @brief Raw mode serial port.
+				 * @note Bytes are received OSSHS_PROTOCOL_SERIAL_BUFFER_SIZE at a time. Written bytes are only buffered,
+				 *       flush() hands them to the kernel.
+				 */
+				class SerialPort
+				{
+				public:
+					static constexpr std::size_t BUFFER_SIZE = OSSHS_PROTOCOL_SERIAL_BUFFER_SIZE;
+
+					SerialPort() = default;
+
+					~SerialPort();
+
+					/**
+					 * @brief Open a serial device in raw 8N1 mode.
+					 * @param path device path, e.g. "/dev/ttyUSB0".
+					 * @param baudRate baud rate in bits per second.
+					 * @return Whether or not the device could be opened.
+					 */
+					bool
+					open(const char *path, uint32_t baudRate);
+
+					/**
+					 * @brief Take over an already open stream, e.g. one end of a socketpair() or a pseudo terminal.
+					 * @param fileDescriptor stream to take over, it is switched to non-blocking mode.
+					 * @return Whether or not the stream could be taken over.
+					 */
+					bool
+					open(int fileDescriptor);
+
+					void
+					close();
+
+					int
+					getFileDescriptor() const;
+
+					/**
+					 * @brief Buffer data for transmission, flushing the buffer if it is full.
+					 * @param data data to write.
+					 * @param length data length.
+					 * @return Number of bytes buffered, the rest has to be written again later.
+					 */
+					std::size_t
+					write(const uint8_t *data, std::size_t length);
+
+					/**
+					 * @brief Hand buffered data to the kernel without waiting.
+					 * @return Whether or not all buffered data was written.
+					 */
+					bool
+					flush();
+
+					bool
+					hasPendingTransmissions() const;
+
+					/**
+					 * @brief Read a single byte without waiting.
+					 * @param data read byte destination.
+					 * @return Whether or not a byte was read.
+					 */
+					bool
+					read(uint8_t &data);
+
+					/**
+					 * @brief Read up to length bytes without waiting.
+					 * @param data destination buffer.
+					 * @param length destination buffer length.
+					 * @return Number of bytes read.
+					 */
+					std::size_t
+					read(uint8_t *data, std::size_t length);
+
+					/**
+					 * @brief Get the number of received bytes buffered by the port, which read() returns without a system
+					 *        call.
+					 * @return Number of buffered bytes.
+					 */
+					std::size_t
+					getReceivedLength() const;
+				private:
+					int fileDescriptor = -1;
+
+					uint8_t rxBuffer[BUFFER_SIZE];
+					std::size_t rxCount = 0;
+					std::size_t rxIndex = 0;
+
+					uint8_t txBuffer[BUFFER_SIZE];
+					std::size_t txCount = 0;
+
+					bool
+					receive();
+
+					SerialPort(const SerialPort&) = delete;
+
+					SerialPort&
+					operator=(const SerialPort&) = delete;
+				};
+
+				/**
+				 * @brief Static serial peripheral usable as the USART parameter of UsartInterface.
+				 * @tparam Index distinguishes ports, every index owns its own port.
+				 */
+				template<uint8_t Index>
+				class HostSerial
+				{
+				public:
+					static SerialPort &
+					getPort()
+					{
+						return port;
+					}
+
+					static std::size_t
+					write(const uint8_t *data, std::size_t length)
+					{
+						return port.write(data, length);
+					}
+
+					static bool
+					read(uint8_t &data)
+					{
+						return port.read(data);
+					}
+
+					static std::size_t
+					read(uint8_t *data, std::size_t length)
+					{
+						return port.read(data, length);
+					}
+
+					static bool
+					isWriteFinished()
+					{
+						return !port.hasPendingTransmissions();
+					}
+
+					static std::size_t
+					receiveBufferSize()
+					{
+						return port.getReceivedLength();
+					}
+				private:
+					static SerialPort port;
+				};
+
+				template<uint8_t Index>
+				SerialPort HostSerial<Index>::port;
+			}
+		}
+	}
+}
+
+#endif  // __linux__
+
+#endif  // OSSHS_PROTOCOL_SERIAL_PORT_HPP
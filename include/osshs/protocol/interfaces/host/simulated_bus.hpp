@@ -0,0 +1,162 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_SIMULATED_BUS_HPP
+#define OSSHS_PROTOCOL_SIMULATED_BUS_HPP
+
+#include <cstdint>
+#include <vector>
+#include <osshs/protocol/protocol_config.hpp>
+#include <osshs/protocol/interfaces/fragmenter.hpp>
+#include <osshs/protocol/interfaces/packet_buffer.hpp>
+#include <osshs/protocol/interfaces/reassembler.hpp>
+#include <osshs/protocol/interfaces/can/can_header.hpp>
+#include <osshs/protocol/interfaces/host/virtual_interface.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				class SimulatedBusInterface;
+
+				/**
+				 * @brief Classic CAN bus simulated in virtual time, e.g. to load test many nodes in a single process.
+				 * @note Interfaces contend for the bus frame by frame with the identifiers a CAN interface would use, the
+				 *       lowest one wins arbitration as on a real bus. Frames are neither lost nor corrupted. Every frame is
+				 *       received by all other interfaces, which reassemble packets from them as a CAN interface would.
+				 */
+				class SimulatedBus
+				{
+				public:
+					SimulatedBus(uint32_t bitRate = OSSHS_PROTOCOL_CAN_BIT_RATE);
+
+					/**
+					 * @brief Get the virtual time.
+					 * @return Nanoseconds since the bus was created.
+					 */
+					uint64_t
+					getTime() const;
+
+					/**
+					 * @brief Get the time the bus was busy transmitting frames.
+					 * @return Busy time in nanoseconds.
+					 */
+					uint64_t
+					getBusyTime() const;
+
+					/**
+					 * @brief Get the number of frames transmitted so far.
+					 * @return Number of frames.
+					 */
+					uint64_t
+					getFrameCount() const;
+
+					/**
+					 * @brief Transmit the frame winning arbitration, or let the bus idle if no interface has one.
+					 * @note Step the managers of all attached interfaces in between, so they can queue their next frames.
+					 * @param until time to idle until.
+					 * @return Whether or not a frame was transmitted.
+					 */
+					bool
+					step(uint64_t until);
+				private:
+					std::vector<SimulatedBusInterface *> interfaces;
+					uint32_t bitRate;
+					uint64_t time = 0;
+					uint64_t busyTime = 0;
+					uint64_t frameCount = 0;
+
+					SimulatedBus(const SimulatedBus&) = delete;
+
+					SimulatedBus&
+					operator=(const SimulatedBus&) = delete;
+
+					friend SimulatedBusInterface;
+				};
+
+				/**
+				 * @brief Virtual interface attached to a simulated bus.
+				 * @note Event packets wait in the queue of the interface until the bus has transmitted the previous one,
+				 *       so queue statistics reflect contention for the bus.
+				 */
+				class SimulatedBusInterface : public VirtualInterface
+				{
+				public:
+					/**
+					 * @brief Attach an interface to a bus. The bus has to outlive it.
+					 * @param bus bus to attach to.
+					 * @param mac mac of the node, used in frame identifiers unless a manager sets another one.
+					 */
+					SimulatedBusInterface(SimulatedBus &bus, uint32_t mac);
+				protected:
+					bool
+					run() override;
+
+					bool
+					isReady() const override;
+				private:
+					SimulatedBus &bus;
+					PacketRef currentEventPacket;
+					PacketBuffer buffer;
+					Fragmenter<can::ClassicCanHeader::MTU, can::ClassicCanHeader> fragmenter;
+					Reassembler<can::ClassicCanHeader::MTU, OSSHS_PROTOCOL_REASSEMBLY_SLOTS, can::ClassicCanHeader> reassembler;
+					bool framePending = false;
+					uint32_t frameIdentifier = 0;
+					uint8_t frameData[can::ClassicCanHeader::MTU];
+					uint8_t frameLength = 0;
+
+					/**
+					 * @brief Take the next frame of the current event packet off the fragmenter.
+					 * @return Whether or not there was one.
+					 */
+					bool
+					loadFrame();
+
+					/**
+					 * @brief Called by the bus once the pending frame is transmitted.
+					 */
+					void
+					completeFrame();
+
+					/**
+					 * @brief Called by the bus once a frame of another interface is transmitted.
+					 * @param identifier frame identifier.
+					 * @param data frame data.
+					 * @param length frame length.
+					 */
+					void
+					deliver(uint32_t identifier, const uint8_t *data, uint8_t length);
+
+					friend SimulatedBus;
+				};
+			}
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_SIMULATED_BUS_HPP
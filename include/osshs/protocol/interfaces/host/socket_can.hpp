@@ -0,0 +1,192 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_SOCKET_CAN_HPP
+#define OSSHS_PROTOCOL_SOCKET_CAN_HPP
+
+#if defined(__linux__)
+
+#include <cstdint>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <linux/can.h>
+#include <modm/platform.hpp>
+#include <osshs/protocol/protocol_config.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				/**
+				 * @brief SocketCAN raw socket exchanging frames in batches.
+				 * @note Frames are received and sent OSSHS_PROTOCOL_SOCKET_BATCH_SIZE at a time. Sent frames are only
+				 *       queued, flush() hands them to the kernel.
+				 */
+				class SocketCanPort
+				{
+				public:
+					static constexpr uint8_t BATCH_SIZE = OSSHS_PROTOCOL_SOCKET_BATCH_SIZE;
+
+					SocketCanPort() = default;
+
+					~SocketCanPort();
+
+					/**
+					 * @brief Open a raw CAN socket bound to a network interface.
+					 * @param interfaceName network interface name, e.g. "can0".
+					 * @return Whether or not the socket could be opened.
+					 */
+					bool
+					open(const char *interfaceName);
+
+					/**
+					 * @brief Take over an already open socket exchanging struct can_frame sized datagrams.
+					 * @note Any connected datagram or sequenced packet socket works, e.g. one end of a socketpair().
+					 * @param fileDescriptor socket to take over, it is switched to non-blocking mode.
+					 * @return Whether or not the socket could be taken over.
+					 */
+					bool
+					open(int fileDescriptor);
+
+					void
+					close();
+
+					/**
+					 * @brief File descriptor getter, e.g. to wait for frames with epoll.
+					 * @return File descriptor or -1 if the port is closed.
+					 */
+					int
+					getFileDescriptor() const;
+
+					bool
+					isMessageAvailable();
+
+					bool
+					getMessage(modm::can::Message &message);
+
+					/**
+					 * @brief Check whether another frame can be queued, flushing the queue if it is full.
+					 * @return Whether or not sendMessage() would succeed.
+					 */
+					bool
+					isReadyToSend();
+
+					/**
+					 * @brief Queue a frame for transmission.
+					 * @param message frame to send.
+					 * @return Whether or not the frame was queued.
+					 */
+					bool
+					sendMessage(const modm::can::Message &message);
+
+					/**
+					 * @brief Hand queued frames to the kernel.
+					 * @return Whether or not all queued frames were sent.
+					 */
+					bool
+					flush();
+
+					bool
+					hasPendingTransmissions() const;
+				private:
+					int fileDescriptor = -1;
+
+					struct can_frame rxFrames[BATCH_SIZE];
+					struct iovec rxVectors[BATCH_SIZE];
+					struct mmsghdr rxHeaders[BATCH_SIZE];
+					uint8_t rxCount = 0;
+					uint8_t rxIndex = 0;
+
+					struct can_frame txFrames[BATCH_SIZE];
+					struct iovec txVectors[BATCH_SIZE];
+					struct mmsghdr txHeaders[BATCH_SIZE];
+					uint8_t txCount = 0;
+
+					void
+					initializeHeaders();
+
+					bool
+					receive();
+
+					SocketCanPort(const SocketCanPort&) = delete;
+
+					SocketCanPort&
+					operator=(const SocketCanPort&) = delete;
+				};
+
+				/**
+				 * @brief Static SocketCAN peripheral usable as the CAN parameter of CanInterface.
+				 * @tparam Index distinguishes buses, every index owns its own port.
+				 */
+				template<uint8_t Index>
+				class SocketCan
+				{
+				public:
+					static SocketCanPort &
+					getPort()
+					{
+						return port;
+					}
+
+					static bool
+					isMessageAvailable()
+					{
+						return port.isMessageAvailable();
+					}
+
+					static bool
+					getMessage(modm::can::Message &message)
+					{
+						return port.getMessage(message);
+					}
+
+					static bool
+					isReadyToSend()
+					{
+						return port.isReadyToSend();
+					}
+
+					static bool
+					sendMessage(const modm::can::Message &message)
+					{
+						return port.sendMessage(message);
+					}
+				private:
+					static SocketCanPort port;
+				};
+
+				template<uint8_t Index>
+				SocketCanPort SocketCan<Index>::port;
+			}
+		}
+	}
+}
+
+#endif  // __linux__
+
+#endif  // OSSHS_PROTOCOL_SOCKET_CAN_HPP
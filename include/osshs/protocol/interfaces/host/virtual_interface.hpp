@@ -0,0 +1,84 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_VIRTUAL_INTERFACE_HPP
+#define OSSHS_PROTOCOL_VIRTUAL_INTERFACE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <osshs/protocol/interfaces/interface.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				/**
+				 * @brief Interface without a medium, e.g. for simulations and benchmarks.
+				 * @note Transmitted event packets are counted and dropped, received ones are injected with receive().
+				 */
+				class VirtualInterface : public Interface
+				{
+				public:
+					VirtualInterface() = default;
+
+					/**
+					 * @brief Get the number of event packets transmitted so far. Safe to call from any thread.
+					 * @return Number of transmitted event packets.
+					 */
+					uint64_t
+					getTransmittedCount() const;
+				protected:
+					bool
+					run() override;
+
+					/**
+					 * @brief Hand an event packet to the manager as if it was received. Call from the stepping thread.
+					 * @param eventPacket received event packet.
+					 * @param packetLength serialized event packet length.
+					 */
+					void
+					receive(PacketRef eventPacket, uint16_t packetLength);
+
+					/**
+					 * @brief Called for every transmitted event packet.
+					 * @param eventPacket transmitted event packet.
+					 */
+					virtual void
+					transmit(const PacketRef &eventPacket);
+				private:
+					std::atomic<uint64_t> transmittedCount{0};
+
+					void
+					initialize() override;
+				};
+			}
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_VIRTUAL_INTERFACE_HPP
@@ -25,9 +25,16 @@
 #ifndef OSSHS_PROTOCOL_INTERFACE_HPP
 #define OSSHS_PROTOCOL_INTERFACE_HPP
 
-#include <queue>
+#include <memory>
+#include <atomic>
 #include <modm/processing/protothread.hpp>
 #include <osshs/protocol/interfaces/event_packet.hpp>
+#include <osshs/protocol/interfaces/event_packet_queue.hpp>
+#include <osshs/protocol/interfaces/packet_buffer.hpp>
+#include <osshs/protocol/interfaces/event_subscription.hpp>
+#include <osshs/protocol/interfaces/token_bucket.hpp>
+#include <osshs/protocol/interfaces/interface_statistics.hpp>
+#include <osshs/protocol/diagnostics/capture.hpp>
 
 namespace osshs
 {
@@ -37,12 +44,123 @@ namespace osshs
 		{
 			class InterfaceManager;
 
+			namespace host
+			{
+				class InterfaceWorker;
+			}
+
+			template<typename... Interfaces>
+			class StaticInterfaceManager;
+
+			class Interface;
+
+			typedef void (*EventPacketRouter)(void *context, PacketRef eventPacket, Interface *sourceInterface);
+
+			typedef Backpressure (*EventRouter)(void *context, std::shared_ptr<events::Event> event);
+
 			class Interface : public modm::pt::Protothread
 			{
 			public:
 				Interface() = default;
+
+				/**
+				 * @brief Statistics getter.
+				 * @return Runtime counters of this interface.
+				 */
+				const InterfaceStatistics &
+				getStatistics() const;
+
+				/**
+				 * @brief Reset all runtime counters of this interface.
+				 */
+				void
+				resetStatistics();
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+				/**
+				 * @brief Latency profile getter.
+				 * @return Latency histograms of this interface.
+				 */
+				const diagnostics::LatencyProfile &
+				getLatencyProfile() const;
+#endif
+
+				/**
+				 * @brief Event type subscriptions getter.
+				 * @note Multi target event packets of event types this interface is not subscribed to are never
+				 *       enqueued, serialized or transmitted on it. Event packets addressed to a receiver always are.
+				 * @return Event types this interface has consumers for.
+				 */
+				EventSubscription &
+				getSubscription();
+
+				/**
+				 * @brief Configure the outgoing event packet queue.
+				 * @param capacity maximum number of queued event packets.
+				 * @param dropPolicy what to do with new event packets while the queue is full.
+				 * @param coalescing whether or not a new event packet replaces a not yet transmitted one of the same event
+				 *        type and source, so only the latest state is transmitted.
+				 * @return Whether or not the capacity is valid.
+				 */
+				bool
+				configureQueue(std::size_t capacity, DropPolicy dropPolicy, bool coalescing = false);
+
+				/**
+				 * @brief Shape transmission on this interface. Commands are never held back, but do consume tokens.
+				 * @param bytesPerSecond sustained rate or zero to disable shaping.
+				 * @param burstBytes maximum burst.
+				 */
+				void
+				setEgressRate(uint32_t bytesPerSecond, uint32_t burstBytes);
+
+				/**
+				 * @brief Police event packets received on this interface per transmitter. Commands are never dropped.
+				 * @param bytesPerSecond sustained rate of every transmitter or zero to disable policing.
+				 * @param burstBytes maximum burst of every transmitter.
+				 */
+				void
+				setIngressRatePerSource(uint32_t bytesPerSecond, uint32_t burstBytes);
+
+				/**
+				 * @brief Check whether the medium of this interface is congested.
+				 * @note Congestion is reported to producers as Backpressure::CONGESTED.
+				 * @return Whether or not producers should throttle because of this interface.
+				 */
+				virtual bool
+				isCongested();
+
+				/**
+				 * @brief Signal that this interface has work to do. Safe to call from interrupts (e.g. on RX or TX complete).
+				 */
+				void
+				signalReady();
+
+				/**
+				 * @brief Capture every frame or packet sent and received on this interface.
+				 * @note The callback is invoked from the interface protothread, so it has to be quick.
+				 * @param callback capture callback or nullptr to stop capturing.
+				 */
+				void
+				setCaptureCallback(diagnostics::CaptureCallback callback);
+
+				/**
+				 * @brief Set the mac of the device owning this interface, e.g. to identify its frames on a shared bus.
+				 * @note Set by InterfaceManager::setMac() for its interfaces. Call before the interface is run.
+				 * @param mac device mac, 0x00000000 by default.
+				 */
+				void
+				setMac(uint32_t mac);
 			protected:
-				std::queue<std::shared_ptr<EventPacket>> eventPacketQueue;
+				EventPacketQueue eventPacketQueue;
+				InterfaceStatistics statistics;
+				EventSubscription subscription;
+				TokenBucket egressShaper;
+				diagnostics::CaptureCallback captureCallback;
+				uint32_t mac = 0x00000000;
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+				diagnostics::LatencyProfile latencyProfile;
+#endif
 
 				/**
 				 * @brief Run interface protothread.
@@ -50,18 +168,103 @@ namespace osshs
 				virtual bool
 				run() = 0;
 
+				/**
+				 * @brief Check whether stepping the interface protothread would make progress.
+				 * @note Must be cheap, as it is evaluated for idle interfaces on every InterfaceManager::run().
+				 * @return Whether or not this interface has work to do.
+				 */
+				virtual bool
+				isReady() const;
+
+				/**
+				 * @brief Check whether the oldest queued event packet may be transmitted now.
+				 * @note Counts the egress shaper holding transmission back, so call it from the interface protothread.
+				 * @return Whether or not an event packet is queued and not held back by the egress shaper.
+				 */
+				bool
+				isTransmitPending();
+
+				/**
+				 * @brief Check whether the egress shaper is holding the oldest queued event packet back.
+				 * @return Whether or not transmission has to wait.
+				 */
+				bool
+				isEgressBlocked() const;
+
 				/**
 				 * @brief Report an event packet to be transmitted.
+				 * @note With OSSHS_PROTOCOL_THREADED the event packet is handed to the worker thread of this interface.
+				 * @param eventPacket event packet to transmit.
+				 * @return Backpressure of this interface.
+				 */
+				Backpressure
+				reportEventPacket(PacketRef eventPacket);
+
+				/**
+				 * @brief Apply the subscription filter and queue an event packet for transmission.
 				 * @param eventPacket event packet to transmit.
+				 * @return Backpressure of this interface.
+				 */
+				Backpressure
+				enqueueEventPacket(PacketRef eventPacket);
+
+				/**
+				 * @brief Serialize an event packet taken from the queue for transmission.
+				 * @note With OSSHS_PROTOCOL_CONTAINER_EVENTS above one, event packets mergeable with it at the head of the
+				 *       queue are taken from the queue as well and serialized into the same container packet.
+				 * @param eventPacket event packet to serialize.
+				 * @param buffer destination buffer.
+				 * @return Whether or not serialization succeeded.
+				 */
+				bool
+				serializeEventPacket(const PacketRef &eventPacket, PacketBuffer &buffer);
+
+				/**
+				 * @brief Hand a received event packet to the manager owning this interface.
+				 * @note Event packets unpacked from the same container packet are handed over one by one.
+				 * @param eventPacket received event packet.
+				 * @param packetLength serialized event packet length, charged to the transmitter's ingress rate limit.
 				 */
 				void
-				reportEventPacket(std::shared_ptr<EventPacket> eventPacket);
+				routeEventPacket(PacketRef eventPacket, uint16_t packetLength);
+
+				/**
+				 * @brief Get a callback for events received by this interface, reporting e.g. responses to the manager
+				 *        owning this interface.
+				 * @return Event callback.
+				 */
+				events::EventCallback
+				getEventCallback();
 			private:
 				Interface(const Interface&) = delete;
 
 				Interface&
 				operator=(const Interface&) = delete;
 
+				static constexpr uint8_t NO_INDEX = 0xff;
+
+				uint8_t interfaceIndex = NO_INDEX;
+				bool egressThrottling = false;
+				SourceRateLimiter ingressLimiter;
+				EventPacketRouter eventPacketRouter = nullptr;
+				EventRouter eventRouter = nullptr;
+				void *routerContext = nullptr;
+				std::atomic<uint32_t> *readyMask = nullptr;
+
+#if OSSHS_PROTOCOL_THREADED
+				host::InterfaceWorker *worker = nullptr;
+#endif
+
+#if OSSHS_PROTOCOL_CONTAINER_EVENTS > 1
+				/**
+				 * @brief Check whether the oldest queued event packet may share a container packet with another one.
+				 * @param eventPacket event packet to merge with.
+				 * @return Whether or not the queue is not empty and its oldest event packet is mergeable.
+				 */
+				bool
+				isFrontMergeableWith(const EventPacket &eventPacket) const;
+#endif
+
 				/**
 				 * @brief Initialize the interface. Should only be called from InterfaceManager.
 				 */
@@ -69,6 +272,10 @@ namespace osshs
 				initialize() = 0;
 
 				friend InterfaceManager;
+				friend host::InterfaceWorker;
+
+				template<typename... Interfaces>
+				friend class StaticInterfaceManager;
 			};
 		}
 	}
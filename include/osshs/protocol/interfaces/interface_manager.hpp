@@ -27,8 +27,16 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <modm/processing/timer.hpp>
+#include <osshs/protocol/protocol_config.hpp>
+#include <osshs/protocol/memory/static_vector.hpp>
+#include <osshs/protocol/utility/delegate.hpp>
 #include <osshs/protocol/interfaces/interface.hpp>
 #include <osshs/protocol/interfaces/event_packet.hpp>
+#include <osshs/protocol/interfaces/request_table.hpp>
+#include <osshs/protocol/interfaces/host/interface_worker.hpp>
 #include <osshs/events/event.hpp>
 
 namespace osshs
@@ -37,44 +45,241 @@ namespace osshs
 	{
 		namespace interfaces
 		{
+			typedef utility::Delegate<void (std::size_t interfaceIndex, const InterfaceStatistics &statistics)> StatisticsCallback;
+
+			typedef utility::Delegate<void (std::shared_ptr<events::Event> event)> EventSink;
+
+#if OSSHS_PROTOCOL_STATIC_MEMORY
+			typedef memory::StaticVector<Interface*, OSSHS_PROTOCOL_MAX_INTERFACES> InterfaceList;
+#else
+			typedef std::vector<Interface*> InterfaceList;
+#endif
+
+			/**
+			 * @brief Interface manager over interfaces registered at runtime.
+			 * @note Every instance is an independent protocol stack, interfaces are bound to the instance they are
+			 *       registered with. Registered interfaces must outlive the instance, which unbinds them when destroyed.
+			 */
 			class InterfaceManager
 			{
 			public:
+				InterfaceManager();
+
+				~InterfaceManager();
+
 				/**
 				 * @brief Initialize the interface manager.
 				 */
-				static void
+				void
 				initialize();
 
 				/**
 				 * @brief Register an interface.
 				 * @param interface interface to register.
 				 */
-				static void
+				void
 				registerInterface(Interface *interface);
 
 				/**
 				 * @brief Report event packet. Should be called from within interfaces.
 				 * @param eventPacket event packet to report.
 				 * @param sourceInterface pointer to the source interface.
+				 * @return Worst backpressure of all interfaces the event packet was forwarded to.
 				 */
-				static void
-				reportEventPacket(std::shared_ptr<EventPacket> eventPacket, Interface *sourceInterface = nullptr);
+				Backpressure
+				reportEventPacket(PacketRef eventPacket, Interface *sourceInterface = nullptr);
 
 				/**
-				 * @brief Report event. Should be called from System.
+				 * @brief Report event. Should be called from System or the event sink owner.
 				 * @param event event to report.
+				 * @return Worst backpressure of all interfaces, producers should throttle unless it is Backpressure::NONE.
 				 */
-				static void
+				Backpressure
 				reportEvent(std::shared_ptr<events::Event> event);
 
 				/**
-				 * @brief Update all registered interfaces.
+				 * @brief Send a command and track the response to it.
+				 * @note The callback is invoked exactly once, from the interface that received the response or from run()
+				 *       once the request timed out. Retries reuse the request id, so responders can recognise them.
+				 * @param command command event.
+				 * @param receiverMac receiver mac or EventPacket::NULL_MAC to accept the first response of any receiver.
+				 * @param callback callback invoked with the response or on timeout.
+				 * @param timeout time to wait for a response before each retry, checked from run().
+				 * @param retries number of times the command is resent while no response arrives.
+				 * @return Handle of the request, invalid if OSSHS_PROTOCOL_PENDING_REQUESTS requests are pending already
+				 *         or the command could not be allocated.
 				 */
-				static void
+				RequestHandle
+				sendRequest(std::shared_ptr<events::Event> command, uint32_t receiverMac, ResponseCallback callback,
+					std::chrono::milliseconds timeout, uint8_t retries = 0);
+
+				/**
+				 * @brief Stop tracking a request without invoking its callback. A late response is discarded.
+				 * @param handle handle of the request.
+				 * @return Whether or not the request was pending.
+				 */
+				bool
+				cancelRequest(RequestHandle handle);
+
+				/**
+				 * @brief Check whether a request still waits for its response.
+				 * @param handle handle of the request.
+				 * @return Whether or not the request is pending.
+				 */
+				bool
+				isPending(RequestHandle handle);
+
+				/**
+				 * @brief Respond to a tracked request.
+				 * @param request request to respond to.
+				 * @param response response event.
+				 * @return Worst backpressure of all interfaces.
+				 */
+				Backpressure
+				respond(const Request &request, std::shared_ptr<events::Event> response);
+
+				/**
+				 * @brief Set where tracked requests for this device are delivered.
+				 * @note Without a handler, tracked requests are delivered to the event sink like any other command.
+				 * @param handler request handler or nullptr.
+				 */
+				void
+				setRequestHandler(RequestHandler handler);
+
+				/**
+				 * @brief Set the mac of this device, which events and requests are sent from and responses are accepted for.
+				 * @note Also sets the mac of every interface registered before or after. Call before the interfaces are run.
+				 * @param mac device mac, 0x00000000 by default.
+				 */
+				void
+				setMac(uint32_t mac);
+
+				/**
+				 * @brief Step registered interfaces that have work to do and expire tracked requests.
+				 * @note Once worker threads are started, only requests are expired and periodic statistics are published
+				 *       from here.
+				 */
+				void
 				run();
+
+#if OSSHS_PROTOCOL_THREADED
+				/**
+				 * @brief Start a worker thread for every registered interface. Register all interfaces first.
+				 */
+				void
+				start();
+
+				/**
+				 * @brief Stop all worker threads and return to stepping interfaces from run().
+				 */
+				void
+				stop();
+#endif
+
+				/**
+				 * @brief Check whether no registered interface has work to do, e.g. before blocking on an event loop.
+				 * @return Whether or not run() would step no interface.
+				 */
+				bool
+				isIdle();
+
+				/**
+				 * @brief Mark an interface as having work to do. Safe to call from interrupts.
+				 * @param interface interface to mark.
+				 */
+				void
+				signalReady(Interface *interface);
+
+				/**
+				 * @brief Get the number of registered interfaces.
+				 * @return Number of registered interfaces.
+				 */
+				std::size_t
+				getInterfaceCount();
+
+				/**
+				 * @brief Take a snapshot of registered interface statistics.
+				 * @param interfaceIndex index of the interface in registration order.
+				 * @param statistics snapshot destination.
+				 * @return Whether or not an interface with the given index exists.
+				 */
+				bool
+				getStatistics(std::size_t interfaceIndex, InterfaceStatistics &statistics);
+
+				/**
+				 * @brief Reset statistics of all registered interfaces.
+				 */
+				void
+				resetStatistics();
+
+				/**
+				 * @brief Periodically publish statistics of all registered interfaces.
+				 * @param callback callback invoked once per interface, e.g. to report a diagnostic event, or nullptr to disable.
+				 * @param period publishing period.
+				 */
+				void
+				setStatisticsCallback(StatisticsCallback callback, std::chrono::milliseconds period = std::chrono::milliseconds(10000));
+
+				/**
+				 * @brief Set where events received by registered interfaces are delivered.
+				 * @param sink event sink, System::reportEvent by default.
+				 */
+				void
+				setEventSink(EventSink sink);
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+				/**
+				 * @brief Take a snapshot of registered interface latency histograms.
+				 * @param interfaceIndex index of the interface in registration order.
+				 * @param latencyProfile snapshot destination.
+				 * @return Whether or not an interface with the given index exists.
+				 */
+				bool
+				getLatencyProfile(std::size_t interfaceIndex, diagnostics::LatencyProfile &latencyProfile);
+#endif
 			private:
-				static std::vector<Interface*> interfaces;
+				static constexpr std::size_t MAX_SIGNALLED_INTERFACES = 32;
+
+				InterfaceList interfaces;
+				std::atomic<uint32_t> readyMask;
+				StatisticsCallback statisticsCallback;
+				modm::ShortPeriodicTimer statisticsTimer;
+				EventSink eventSink;
+				RequestHandler requestHandler;
+				RequestTable pendingRequests;
+				uint32_t mac = 0x00000000;
+
+#if OSSHS_PROTOCOL_THREADED
+				std::vector<std::unique_ptr<host::InterfaceWorker>> workers;
+				std::mutex sinkMutex;
+				std::mutex requestMutex;
+#endif
+
+				InterfaceManager(const InterfaceManager&) = delete;
+
+				InterfaceManager&
+				operator=(const InterfaceManager&) = delete;
+
+				static void
+				routeEventPacket(void *context, PacketRef eventPacket, Interface *sourceInterface);
+
+				static Backpressure
+				routeEvent(void *context, std::shared_ptr<events::Event> event);
+
+				void
+				publishStatistics();
+
+				Backpressure
+				transmit(const PacketRef &eventPacket);
+
+				void
+				completeRequest(const EventPacket &response);
+
+				void
+				expireRequests();
+
+				void
+				sleepUntilReady();
 			};
 		}
 	}
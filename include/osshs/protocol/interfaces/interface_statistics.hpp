@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_INTERFACE_STATISTICS_HPP
+#define OSSHS_PROTOCOL_INTERFACE_STATISTICS_HPP
+
+#include <cstdint>
+#include <osshs/protocol/protocol_config.hpp>
+
+#if OSSHS_PROTOCOL_THREADED
+	#include <atomic>
+#endif
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+#if OSSHS_PROTOCOL_THREADED
+			/**
+			 * @brief Counter updated by an interface worker thread and read by others, with relaxed atomic operations.
+			 */
+			class StatisticsCounter
+			{
+			public:
+				StatisticsCounter(uint32_t value = 0)
+					: value(value)
+				{
+				}
+
+				StatisticsCounter(const StatisticsCounter &other)
+					: value(other)
+				{
+				}
+
+				StatisticsCounter &
+				operator=(const StatisticsCounter &other)
+				{
+					value.store(other, std::memory_order_relaxed);
+					return *this;
+				}
+
+				StatisticsCounter &
+				operator=(uint32_t value)
+				{
+					this->value.store(value, std::memory_order_relaxed);
+					return *this;
+				}
+
+				operator uint32_t() const
+				{
+					return value.load(std::memory_order_relaxed);
+				}
+
+				StatisticsCounter &
+				operator++()
+				{
+					value.fetch_add(1, std::memory_order_relaxed);
+					return *this;
+				}
+
+				uint32_t
+				operator++(int)
+				{
+					return value.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				StatisticsCounter &
+				operator+=(uint32_t increment)
+				{
+					value.fetch_add(increment, std::memory_order_relaxed);
+					return *this;
+				}
+			private:
+				std::atomic<uint32_t> value;
+			};
+#else
+			typedef uint32_t StatisticsCounter;
+#endif
+
+			/**
+			 * @brief Fixed-size runtime counters kept by interfaces and interface controllers.
+			 * @note Counters wrap around on overflow. With OSSHS_PROTOCOL_THREADED they may be read while being updated.
+			 */
+			struct InterfaceStatistics
+			{
+				StatisticsCounter packetsIn = 0;
+				StatisticsCounter packetsOut = 0;
+				StatisticsCounter framesIn = 0;
+				StatisticsCounter framesOut = 0;
+				StatisticsCounter bytesIn = 0;
+				StatisticsCounter bytesOut = 0;
+				StatisticsCounter malformedDrops = 0;
+				StatisticsCounter allocationFailures = 0;
+				StatisticsCounter queueHighWaterMark = 0;
+				StatisticsCounter queueDrops = 0;
+				StatisticsCounter queueCoalesced = 0;
+				StatisticsCounter reassemblyTimeouts = 0;
+				StatisticsCounter txMailboxStalls = 0;
+				StatisticsCounter unsubscribedDrops = 0;
+				StatisticsCounter egressThrottled = 0;   // Times transmission was held back by the egress shaper.
+				StatisticsCounter ingressThrottled = 0;  // Received packets dropped by the per source rate limiter.
+				StatisticsCounter ingressEvictions = 0;  // Transmitters the per source rate limiter had to forget.
+				StatisticsCounter framesForwarded = 0;   // Frames handed to a cut-through peer.
+				StatisticsCounter forwardDrops = 0;      // Frames a cut-through peer had no room for.
+				StatisticsCounter eventsMerged = 0;      // Events sent in a container packet behind the first one.
+				StatisticsCounter eventsUnpacked = 0;    // Events received in a container packet behind the first one.
+
+				/**
+				 * @brief Update queue high-water mark.
+				 * @param queueSize current queue size.
+				 */
+				void
+				updateQueueHighWaterMark(uint32_t queueSize)
+				{
+					if (queueSize > queueHighWaterMark)
+						queueHighWaterMark = queueSize;
+				}
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_INTERFACE_STATISTICS_HPP
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_PACKET_BUFFER_HPP
+#define OSSHS_PROTOCOL_PACKET_BUFFER_HPP
+
+#include <osshs/protocol/interfaces/event_packet.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			/**
+			 * @brief Buffer holding a single serialized event packet.
+			 * @note Storage is drawn from the slab pools on demand and returned on release.
+			 */
+			class PacketBuffer
+			{
+			public:
+				PacketBuffer() = default;
+
+				~PacketBuffer();
+
+				/**
+				 * @brief Make room for a serialized event packet.
+				 * @param length serialized event packet length.
+				 * @return Whether or not the buffer could be allocated.
+				 */
+				bool
+				allocate(uint16_t length);
+
+				/**
+				 * @brief Serialize an event packet into this buffer.
+				 * @param eventPacket event packet to serialize.
+				 * @return Whether or not serialization succeeded.
+				 */
+				bool
+				serialize(const EventPacket &eventPacket);
+
+				/**
+				 * @brief Serialize a container packet into this buffer, see EventPacket::serializeContainer().
+				 * @param eventPacket first event packet of the container packet.
+				 * @param events serialized events, starting with the event of the first event packet.
+				 * @param eventCount number of events.
+				 * @return Whether or not serialization succeeded.
+				 */
+				bool
+				serializeContainer(const EventPacket &eventPacket, const std::unique_ptr<const uint8_t[]> *events, uint8_t eventCount);
+
+				/**
+				 * @brief Release the held event packet.
+				 */
+				void
+				release();
+
+				/**
+				 * @brief Writable data getter. Only valid after a successful allocate().
+				 * @return Pointer to data.
+				 */
+				uint8_t *
+				getWritable();
+
+				/**
+				 * @brief Data getter.
+				 * @return Pointer to data.
+				 */
+				const uint8_t *
+				get() const;
+
+				/**
+				 * @brief Length getter.
+				 * @return Serialized event packet length or zero if the buffer is empty.
+				 */
+				uint16_t
+				getLength() const;
+
+				const uint8_t &
+				operator[](uint16_t index) const
+				{
+					return get()[index];
+				}
+			private:
+				uint8_t *data = nullptr;
+				uint16_t length = 0;
+
+				static uint8_t *
+				provide(void *context, uint16_t packetLength);
+
+				PacketBuffer(const PacketBuffer&) = delete;
+
+				PacketBuffer&
+				operator=(const PacketBuffer&) = delete;
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_PACKET_BUFFER_HPP
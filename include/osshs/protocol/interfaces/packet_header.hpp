@@ -0,0 +1,223 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_PACKET_HEADER_HPP
+#define OSSHS_PROTOCOL_PACKET_HEADER_HPP
+
+#include <cstdint>
+#include <osshs/protocol/utility/bit_field.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			/**
+			 * @brief Wire layout of the event packet header, see docs/PACKET.md.
+			 */
+			struct PacketHeader
+			{
+				typedef utility::ByteField<0, 2> PacketLength;
+				typedef utility::ByteField<2, 1> Flags;
+				typedef utility::ByteField<3, 4> TransmitterMac;
+				typedef utility::ByteField<7, 4> ReceiverMac;
+
+				typedef utility::BitField<uint8_t, 7, 1> MultiTargetFlag;
+				typedef utility::BitField<uint8_t, 6, 1> CommandFlag;
+				typedef utility::BitField<uint8_t, 5, 1> CompressedFlag;
+				typedef utility::BitField<uint8_t, 4, 1> ContainerFlag;
+				typedef utility::BitField<uint8_t, 3, 1> RequestIdFlag;
+
+				// Tracked requests and their responses carry a request id right after the mac addresses.
+				typedef utility::ByteField<0, 2> RequestId;
+
+				// Serialized events start with their own length and type.
+				typedef utility::ByteField<0, 2> EventLength;
+				typedef utility::ByteField<2, 2> EventType;
+
+				static constexpr uint16_t MULTI_TARGET_LENGTH = TransmitterMac::END;
+				static constexpr uint16_t SINGLE_TARGET_LENGTH = ReceiverMac::END;
+				static constexpr uint16_t MIN_EVENT_LENGTH = EventType::END;
+				static constexpr uint8_t MAX_CONTAINER_EVENTS = 16;
+				static constexpr uint16_t NO_REQUEST_ID = 0;
+
+				static_assert(Flags::OFFSET == PacketLength::END && TransmitterMac::OFFSET == Flags::END &&
+					ReceiverMac::OFFSET == TransmitterMac::END, "Packet header fields must be contiguous.");
+
+				/**
+				 * @brief Decoded event packet header.
+				 */
+				struct Fields
+				{
+					uint16_t packetLength;
+					bool multiTarget;
+					bool command;
+					bool compressed;
+					bool container;
+					uint8_t eventCount;
+					uint32_t transmitterMac;
+					uint32_t receiverMac;
+					uint16_t requestId;
+					uint16_t eventOffset;
+					uint16_t eventLength;
+					uint16_t eventType;
+				};
+
+				static constexpr uint16_t
+				getHeaderLength(bool multiTarget, bool hasRequestId = false)
+				{
+					return (multiTarget ? MULTI_TARGET_LENGTH : SINGLE_TARGET_LENGTH) + (hasRequestId ? RequestId::END : 0);
+				}
+
+				/**
+				 * @brief Decode and validate an event packet header.
+				 * @note Every field is checked against the buffer length before it is read, so untrusted input is safe
+				 *       to pass. The serialized event is only checked for its length and type. The length of a compressed
+				 *       event is its uncompressed length, which must exceed the space the event takes in the packet. The
+				 *       events of a container packet are all checked for their lengths, the fields describe the first.
+				 * @param data serialized event packet.
+				 * @param length serialized event packet buffer length.
+				 * @param fields decoded header, only valid on success.
+				 * @return Whether or not the header is valid.
+				 */
+				static constexpr bool
+				decode(const uint8_t *data, uint16_t length, Fields &fields)
+				{
+					if (length < MULTI_TARGET_LENGTH)
+						return false;
+
+					fields.packetLength = PacketLength::read(data);
+
+					uint8_t flags = Flags::read(data);
+					fields.multiTarget = MultiTargetFlag::get(flags);
+					fields.command = CommandFlag::get(flags);
+					fields.compressed = CompressedFlag::get(flags);
+					fields.container = ContainerFlag::get(flags);
+					fields.transmitterMac = TransmitterMac::read(data);
+
+					bool hasRequestId = RequestIdFlag::get(flags);
+					fields.eventOffset = getHeaderLength(fields.multiTarget, hasRequestId);
+
+					if (fields.packetLength > length || fields.packetLength < fields.eventOffset + MIN_EVENT_LENGTH)
+						return false;
+
+					fields.receiverMac = fields.multiTarget ? static_cast<uint32_t>(-1) : ReceiverMac::read(data);
+					fields.requestId = hasRequestId ? RequestId::read(&data[getHeaderLength(fields.multiTarget)]) : NO_REQUEST_ID;
+
+					if (hasRequestId && fields.requestId == NO_REQUEST_ID)
+						return false;
+
+					const uint8_t *event = &data[fields.eventOffset];
+					fields.eventLength = EventLength::read(event);
+					fields.eventType = EventType::read(event);
+
+					if (fields.container)
+					{
+						if (fields.compressed)
+							return false;
+
+						uint16_t offset = fields.eventOffset;
+
+						for (fields.eventCount = 0; offset != fields.packetLength; fields.eventCount++)
+						{
+							if (fields.eventCount == MAX_CONTAINER_EVENTS || fields.packetLength - offset < MIN_EVENT_LENGTH)
+								return false;
+
+							uint16_t eventLength = EventLength::read(&data[offset]);
+
+							if (eventLength < MIN_EVENT_LENGTH || eventLength > fields.packetLength - offset)
+								return false;
+
+							offset += eventLength;
+						}
+
+						return true;
+					}
+
+					fields.eventCount = 1;
+
+					if (fields.compressed)
+						return fields.eventOffset + fields.eventLength > fields.packetLength;
+
+					return fields.eventOffset + fields.eventLength == fields.packetLength;
+				}
+
+				/**
+				 * @brief Advance decoded header fields to the next event of a container packet.
+				 * @param data serialized event packet the fields were decoded from.
+				 * @param fields header fields successfully decoded by decode().
+				 * @return Whether or not there was another event.
+				 */
+				static constexpr bool
+				nextEvent(const uint8_t *data, Fields &fields)
+				{
+					if (fields.eventOffset + fields.eventLength >= fields.packetLength)
+						return false;
+
+					fields.eventOffset += fields.eventLength;
+
+					const uint8_t *event = &data[fields.eventOffset];
+					fields.eventLength = EventLength::read(event);
+					fields.eventType = EventType::read(event);
+
+					return true;
+				}
+
+				/**
+				 * @brief Encode an event packet header.
+				 * @param data destination of at least getHeaderLength(multiTarget, requestId != NO_REQUEST_ID) bytes.
+				 * @param packetLength serialized event packet length.
+				 * @param multiTarget whether or not the event packet is multi target.
+				 * @param command whether or not the event packet is a command.
+				 * @param transmitterMac transmitter mac.
+				 * @param receiverMac receiver mac, ignored for multi target event packets.
+				 * @param compressed whether or not the serialized event is compressed.
+				 * @param container whether or not several serialized events follow the header.
+				 * @param requestId request id of a tracked request or its response, NO_REQUEST_ID otherwise.
+				 */
+				static constexpr void
+				encode(uint8_t *data, uint16_t packetLength, bool multiTarget, bool command, uint32_t transmitterMac, uint32_t receiverMac,
+					bool compressed = false, bool container = false, uint16_t requestId = NO_REQUEST_ID)
+				{
+					uint8_t flags = MultiTargetFlag::set(CommandFlag::set(0, command), multiTarget);
+					flags = ContainerFlag::set(CompressedFlag::set(flags, compressed), container);
+					flags = RequestIdFlag::set(flags, requestId != NO_REQUEST_ID);
+
+					PacketLength::write(data, packetLength);
+					Flags::write(data, flags);
+					TransmitterMac::write(data, transmitterMac);
+
+					if (!multiTarget)
+						ReceiverMac::write(data, receiverMac);
+
+					if (requestId != NO_REQUEST_ID)
+						RequestId::write(&data[getHeaderLength(multiTarget)], requestId);
+				}
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_PACKET_HEADER_HPP
@@ -0,0 +1,178 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_EVENT_PACKET_HPP
+	#error "Don't include this file directly, use 'event_packet.hpp' instead!"
+#endif
+
+#ifndef OSSHS_PROTOCOL_PACKET_REF_HPP
+#define OSSHS_PROTOCOL_PACKET_REF_HPP
+
+#include <cstddef>
+#include <utility>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			/**
+			 * @brief Intrusive reference counted handle to an event packet.
+			 * @note The reference count lives inside the event packet, so copying a handle costs a single increment
+			 *       and moving it costs nothing.
+			 */
+			class PacketRef
+			{
+			public:
+				PacketRef() = default;
+
+				PacketRef(std::nullptr_t)
+				{
+				}
+
+				/**
+				 * @brief Take a reference to an event packet.
+				 * @param eventPacket event packet allocated by EventPacket::make() or nullptr.
+				 */
+				explicit PacketRef(EventPacket *eventPacket)
+					: eventPacket(eventPacket)
+				{
+					acquire();
+				}
+
+				PacketRef(const PacketRef &other)
+					: eventPacket(other.eventPacket)
+				{
+					acquire();
+				}
+
+				PacketRef(PacketRef &&other)
+					: eventPacket(other.eventPacket)
+				{
+					other.eventPacket = nullptr;
+				}
+
+				~PacketRef()
+				{
+					release();
+				}
+
+				PacketRef &
+				operator=(const PacketRef &other)
+				{
+					if (eventPacket != other.eventPacket)
+					{
+						release();
+						eventPacket = other.eventPacket;
+						acquire();
+					}
+
+					return *this;
+				}
+
+				PacketRef &
+				operator=(PacketRef &&other)
+				{
+					if (this != &other)
+					{
+						release();
+						eventPacket = other.eventPacket;
+						other.eventPacket = nullptr;
+					}
+
+					return *this;
+				}
+
+				/**
+				 * @brief Drop the reference, destroying the event packet if this was the last one.
+				 */
+				void
+				reset()
+				{
+					release();
+					eventPacket = nullptr;
+				}
+
+				EventPacket *
+				get() const
+				{
+					return eventPacket;
+				}
+
+				EventPacket *
+				operator->() const
+				{
+					return eventPacket;
+				}
+
+				EventPacket &
+				operator*() const
+				{
+					return *eventPacket;
+				}
+
+				explicit operator bool() const
+				{
+					return eventPacket != nullptr;
+				}
+
+				bool
+				operator==(std::nullptr_t) const
+				{
+					return eventPacket == nullptr;
+				}
+
+				bool
+				operator!=(std::nullptr_t) const
+				{
+					return eventPacket != nullptr;
+				}
+
+				bool
+				operator==(const PacketRef &other) const
+				{
+					return eventPacket == other.eventPacket;
+				}
+
+				bool
+				operator!=(const PacketRef &other) const
+				{
+					return eventPacket != other.eventPacket;
+				}
+			private:
+				EventPacket *eventPacket = nullptr;
+
+				// Defined in event_packet.hpp, as event packets hold references themselves.
+				void
+				acquire();
+
+				void
+				release();
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_PACKET_REF_HPP
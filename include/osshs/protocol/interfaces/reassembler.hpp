@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_REASSEMBLER_HPP
+#define OSSHS_PROTOCOL_REASSEMBLER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <modm/platform.hpp>
+#include <osshs/protocol/interfaces/fragmenter.hpp>
+#include <osshs/protocol/interfaces/packet_buffer.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			enum class ReassemblyResult : uint8_t
+			{
+				INCOMPLETE,  // Fragment was taken, more are needed.
+				COMPLETE,    // Packet is complete and available from getCompleted().
+				MALFORMED,   // Fragment is inconsistent with itself or with the packet in progress and was dropped.
+				ORPHANED,    // Fragment does not belong to any packet in progress and was dropped.
+				NO_MEMORY,   // No buffer could be allocated for the packet.
+			};
+
+			/**
+			 * @brief Reassembles event packets from transport fragments, several senders at a time.
+			 * @note Slot lookup probes at most Slots slots, starting at one derived from the sender key, so it usually
+			 *       takes a single probe. A sender starting a packet while all slots are held by other senders evicts
+			 *       the one in its home slot. Fragments of a packet must arrive in order.
+			 * @tparam MTU maximum fragment length in bytes.
+			 * @tparam Slots number of packets in progress at a time, a power of two.
+			 * @tparam HeaderPolicy header policy of the transport, see Fragmenter.
+			 */
+			template<uint8_t MTU, uint8_t Slots, typename HeaderPolicy>
+			class Reassembler
+			{
+			public:
+				static constexpr uint8_t PAYLOAD_LENGTH = Fragmenter<MTU, HeaderPolicy>::PAYLOAD_LENGTH;
+
+				static_assert(Slots > 0 && (Slots & (Slots - 1)) == 0, "Reassembler slot count must be a power of two.");
+
+				/**
+				 * @brief Take a fragment.
+				 * @param key sender key, e.g. the transmitter mac.
+				 * @param identifier transport identifier of the fragment.
+				 * @param data fragment data.
+				 * @param length fragment length.
+				 * @param timestamp opaque capture timestamp, kept for the first fragment of a packet.
+				 * @return What happened to the fragment.
+				 */
+				ReassemblyResult
+				push(uint32_t key, uint32_t identifier, const uint8_t *data, uint8_t length, uint32_t timestamp = 0);
+
+				/**
+				 * @brief Completed packet getter. Only valid after push() returned COMPLETE and until the next push().
+				 * @note Release the buffer once the packet is consumed, to return its memory early.
+				 * @return Buffer holding the completed packet.
+				 */
+				PacketBuffer &
+				getCompleted();
+
+				/**
+				 * @brief Capture timestamp of the first fragment of the completed packet.
+				 * @return Timestamp passed to push() with the first fragment.
+				 */
+				uint32_t
+				getCompletedTimestamp() const;
+
+				/**
+				 * @brief Drop packets that did not receive a fragment in time.
+				 * @param timeout maximum time between two fragments of a packet.
+				 * @return Number of dropped packets.
+				 */
+				uint8_t
+				expire(std::chrono::milliseconds timeout);
+			private:
+				struct Slot
+				{
+					PacketBuffer buffer;
+					uint32_t key = 0;
+					uint32_t timestamp = 0;
+					uint16_t fragmentCount = 0;
+					uint16_t nextFragment = 0;
+					modm::Clock::time_point lastFragment;
+					bool active = false;
+				};
+
+				Slot slots[Slots];
+				Slot *completed = nullptr;
+
+				static uint8_t
+				getSlotIndex(uint32_t key);
+
+				/**
+				 * @brief Find the slot of the packet a sender has in progress.
+				 * @param key sender key.
+				 * @return Slot or nullptr if the sender has no packet in progress.
+				 */
+				Slot *
+				findSlot(uint32_t key);
+
+				/**
+				 * @brief Pick a slot for a new packet of a sender.
+				 * @param key sender key.
+				 * @return Slot of the sender's previous packet, a free slot or the sender's home slot, in this order.
+				 */
+				Slot &
+				claimSlot(uint32_t key);
+
+				ReassemblyResult
+				start(Slot &slot, uint32_t key, uint16_t fragmentCount, const uint8_t *payload, uint8_t payloadLength, uint32_t timestamp);
+
+				ReassemblyResult
+				complete(Slot &slot);
+			};
+		}
+	}
+}
+
+#include <osshs/protocol/interfaces/reassembler_impl.hpp>
+
+#endif  // OSSHS_PROTOCOL_REASSEMBLER_HPP
@@ -0,0 +1,220 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_REASSEMBLER_HPP
+	#error "Don't include this file directly, use 'reassembler.hpp' instead!"
+#endif
+
+#include <algorithm>
+#include <osshs/protocol/interfaces/packet_header.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			template<uint8_t MTU, uint8_t Slots, typename HeaderPolicy>
+			ReassemblyResult
+			Reassembler<MTU, Slots, HeaderPolicy>::push(uint32_t key, uint32_t identifier, const uint8_t *data, uint8_t length, uint32_t timestamp)
+			{
+				bool multiFragment = HeaderPolicy::isMultiFragment(identifier, data);
+				uint8_t headerLength = (multiFragment || HeaderPolicy::ALWAYS_IN_BAND) ? HeaderPolicy::IN_BAND_LENGTH : 0;
+
+				if (length < headerLength || length > MTU)
+					return ReassemblyResult::MALFORMED;
+
+				const uint8_t *payload = &data[headerLength];
+				uint8_t payloadLength = length - headerLength;
+				uint16_t number = HeaderPolicy::getNumber(identifier, data);
+
+				if (HeaderPolicy::isFirst(identifier, data))
+				{
+					// A sender only ever has one packet in progress, so a new first fragment abandons the previous one.
+					return start(claimSlot(key), key, multiFragment ? number : 1, payload, payloadLength, timestamp);
+				}
+
+				Slot *found = findSlot(key);
+				if (found == nullptr)
+					return ReassemblyResult::ORPHANED;
+
+				Slot &slot = *found;
+
+				if (!multiFragment || number != slot.nextFragment)
+				{
+					slot.active = false;
+					slot.buffer.release();
+					return ReassemblyResult::MALFORMED;
+				}
+
+				uint16_t offset = number * PAYLOAD_LENGTH;
+				uint16_t bufferLength = slot.buffer.getLength();
+				uint16_t copyLength = std::min<uint16_t>(payloadLength, bufferLength - offset);
+
+				std::copy(&payload[0], &payload[copyLength], &slot.buffer.getWritable()[offset]);
+
+				slot.nextFragment++;
+				slot.lastFragment = modm::Clock::now();
+
+				if (slot.nextFragment == slot.fragmentCount)
+					return complete(slot);
+
+				return ReassemblyResult::INCOMPLETE;
+			}
+
+			template<uint8_t MTU, uint8_t Slots, typename HeaderPolicy>
+			PacketBuffer &
+			Reassembler<MTU, Slots, HeaderPolicy>::getCompleted()
+			{
+				return completed->buffer;
+			}
+
+			template<uint8_t MTU, uint8_t Slots, typename HeaderPolicy>
+			uint32_t
+			Reassembler<MTU, Slots, HeaderPolicy>::getCompletedTimestamp() const
+			{
+				return completed->timestamp;
+			}
+
+			template<uint8_t MTU, uint8_t Slots, typename HeaderPolicy>
+			uint8_t
+			Reassembler<MTU, Slots, HeaderPolicy>::expire(std::chrono::milliseconds timeout)
+			{
+				modm::Clock::time_point now = modm::Clock::now();
+				uint8_t expired = 0;
+
+				for (Slot &slot : slots)
+				{
+					if (slot.active && (now - slot.lastFragment) > timeout)
+					{
+						slot.active = false;
+						slot.buffer.release();
+						expired++;
+					}
+				}
+
+				return expired;
+			}
+
+			template<uint8_t MTU, uint8_t Slots, typename HeaderPolicy>
+			uint8_t
+			Reassembler<MTU, Slots, HeaderPolicy>::getSlotIndex(uint32_t key)
+			{
+				// Fold the key, so senders differing in their upper bits only still spread over the slots.
+				key ^= key >> 16;
+				key ^= key >> 8;
+
+				return key & (Slots - 1);
+			}
+
+			template<uint8_t MTU, uint8_t Slots, typename HeaderPolicy>
+			typename Reassembler<MTU, Slots, HeaderPolicy>::Slot *
+			Reassembler<MTU, Slots, HeaderPolicy>::findSlot(uint32_t key)
+			{
+				uint8_t index = getSlotIndex(key);
+
+				for (uint8_t probe = 0; probe < Slots; probe++)
+				{
+					Slot &slot = slots[(index + probe) & (Slots - 1)];
+
+					if (slot.active && slot.key == key)
+						return &slot;
+				}
+
+				return nullptr;
+			}
+
+			template<uint8_t MTU, uint8_t Slots, typename HeaderPolicy>
+			typename Reassembler<MTU, Slots, HeaderPolicy>::Slot &
+			Reassembler<MTU, Slots, HeaderPolicy>::claimSlot(uint32_t key)
+			{
+				Slot *slot = findSlot(key);
+				if (slot != nullptr)
+					return *slot;
+
+				uint8_t index = getSlotIndex(key);
+
+				for (uint8_t probe = 0; probe < Slots; probe++)
+				{
+					slot = &slots[(index + probe) & (Slots - 1)];
+
+					if (!slot->active)
+						return *slot;
+				}
+
+				return slots[index];
+			}
+
+			template<uint8_t MTU, uint8_t Slots, typename HeaderPolicy>
+			ReassemblyResult
+			Reassembler<MTU, Slots, HeaderPolicy>::start(Slot &slot, uint32_t key, uint16_t fragmentCount,
+				const uint8_t *payload, uint8_t payloadLength, uint32_t timestamp)
+			{
+				// Whatever the slot held is abandoned or evicted, so its buffer is returned even if this packet is dropped.
+				slot.active = false;
+				slot.buffer.release();
+
+				if (payloadLength < 2)
+					return ReassemblyResult::MALFORMED;
+
+				uint16_t bufferLength = PacketHeader::PacketLength::read(payload);
+
+				// The fragment count is implied by the packet length, anything else is a corrupt or foreign packet.
+				if (fragmentCount != Fragmenter<MTU, HeaderPolicy>::getFragmentCount(bufferLength) ||
+					(fragmentCount == 1 && bufferLength > payloadLength))
+				{
+					return ReassemblyResult::MALFORMED;
+				}
+
+				if (!slot.buffer.allocate(bufferLength))
+					return ReassemblyResult::NO_MEMORY;
+
+				uint16_t copyLength = std::min<uint16_t>(payloadLength, bufferLength);
+				std::copy(&payload[0], &payload[copyLength], slot.buffer.getWritable());
+
+				slot.key = key;
+				slot.timestamp = timestamp;
+				slot.fragmentCount = fragmentCount;
+				slot.nextFragment = 1;
+				slot.lastFragment = modm::Clock::now();
+				slot.active = true;
+
+				if (fragmentCount == 1)
+					return complete(slot);
+
+				return ReassemblyResult::INCOMPLETE;
+			}
+
+			template<uint8_t MTU, uint8_t Slots, typename HeaderPolicy>
+			ReassemblyResult
+			Reassembler<MTU, Slots, HeaderPolicy>::complete(Slot &slot)
+			{
+				slot.active = false;
+				completed = &slot;
+
+				return ReassemblyResult::COMPLETE;
+			}
+		}
+	}
+}
@@ -0,0 +1,162 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_REQUEST_TABLE_HPP
+#define OSSHS_PROTOCOL_REQUEST_TABLE_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <modm/platform.hpp>
+#include <osshs/events/event.hpp>
+#include <osshs/protocol/protocol_config.hpp>
+#include <osshs/protocol/utility/delegate.hpp>
+#include <osshs/protocol/interfaces/packet_header.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			/**
+			 * @brief Outcome of a tracked request.
+			 */
+			enum class RequestStatus : uint8_t
+			{
+				COMPLETED,  // The response arrived.
+				TIMED_OUT,  // No response arrived in time, retries included.
+			};
+
+			typedef utility::Delegate<void (RequestStatus status, std::shared_ptr<events::Event> response)> ResponseCallback;
+
+			/**
+			 * @brief Handle of a tracked request, see InterfaceManager::sendRequest().
+			 */
+			class RequestHandle
+			{
+			public:
+				RequestHandle() = default;
+
+				explicit RequestHandle(uint16_t requestId)
+					: requestId(requestId)
+				{
+				}
+
+				/**
+				 * @brief Check whether the request was sent and tracked.
+				 * @return Whether or not this handle refers to a request.
+				 */
+				bool
+				isValid() const
+				{
+					return requestId != PacketHeader::NO_REQUEST_ID;
+				}
+
+				uint16_t
+				getRequestId() const
+				{
+					return requestId;
+				}
+			private:
+				uint16_t requestId = PacketHeader::NO_REQUEST_ID;
+			};
+
+			/**
+			 * @brief Tracked request received for this device, answered with InterfaceManager::respond().
+			 */
+			struct Request
+			{
+				std::shared_ptr<events::Event> command;
+				uint32_t transmitterMac;
+				uint16_t requestId;
+			};
+
+			typedef utility::Delegate<void (const Request &request)> RequestHandler;
+
+			/**
+			 * @brief Fixed-size table of tracked requests waiting for their responses.
+			 * @note Not synchronized, the owner serializes access.
+			 */
+			class RequestTable
+			{
+			public:
+				struct Entry
+				{
+					std::shared_ptr<events::Event> command;
+					ResponseCallback callback;
+					modm::Clock::time_point sent;
+					std::chrono::milliseconds timeout;
+					uint32_t receiverMac;
+					uint16_t requestId = PacketHeader::NO_REQUEST_ID;
+					uint8_t retries;
+				};
+
+				/**
+				 * @brief Add a request sent now, assigning it a request id no other pending request uses.
+				 * @param command command event, kept for retries.
+				 * @param receiverMac receiver mac or EventPacket::NULL_MAC if any receiver may respond.
+				 * @param callback callback to complete the request with.
+				 * @param timeout time to wait for a response before each retry.
+				 * @param retries number of times the command is resent without response.
+				 * @return Request id or PacketHeader::NO_REQUEST_ID if the table is full.
+				 */
+				uint16_t
+				add(std::shared_ptr<events::Event> command, uint32_t receiverMac, ResponseCallback callback,
+					std::chrono::milliseconds timeout, uint8_t retries);
+
+				/**
+				 * @brief Find a pending request.
+				 * @param requestId request id.
+				 * @return Pending request or nullptr.
+				 */
+				Entry *
+				find(uint16_t requestId);
+
+				/**
+				 * @brief Find a pending request that has waited for its response for longer than its timeout.
+				 * @return Expired request or nullptr.
+				 */
+				Entry *
+				findExpired();
+
+				/**
+				 * @brief Remove a pending request.
+				 * @param entry request returned by find() or findExpired().
+				 */
+				void
+				release(Entry &entry);
+
+				bool
+				empty() const;
+			private:
+				Entry entries[OSSHS_PROTOCOL_PENDING_REQUESTS];
+				uint16_t lastRequestId = PacketHeader::NO_REQUEST_ID;
+				uint8_t count = 0;
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_REQUEST_TABLE_HPP
@@ -0,0 +1,132 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_STATIC_INTERFACE_MANAGER_HPP
+#define OSSHS_PROTOCOL_STATIC_INTERFACE_MANAGER_HPP
+
+#include <tuple>
+#include <memory>
+#include <utility>
+#include <osshs/protocol/interfaces/interface.hpp>
+#include <osshs/protocol/interfaces/event_packet.hpp>
+#include <osshs/events/event.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			/**
+			 * @brief Interface manager over a set of interfaces known at compile time.
+			 * @note Interfaces are held by value and all fan-out and scheduling is unrolled and dispatched
+			 *       without virtual calls. Use InterfaceManager when interfaces are registered at runtime.
+			 */
+			template<typename... Interfaces>
+			class StaticInterfaceManager
+			{
+			public:
+				StaticInterfaceManager();
+
+				/**
+				 * @brief Initialize all interfaces.
+				 */
+				void
+				initialize();
+
+				/**
+				 * @brief Report event packet. Called by interfaces when a packet is received.
+				 * @param eventPacket event packet to report.
+				 * @param sourceInterface pointer to the source interface.
+				 * @return Worst backpressure of all interfaces the event packet was forwarded to.
+				 */
+				Backpressure
+				reportEventPacket(PacketRef eventPacket, Interface *sourceInterface = nullptr);
+
+				/**
+				 * @brief Report event. Should be called from System.
+				 * @param event event to report.
+				 * @return Worst backpressure of all interfaces, producers should throttle unless it is Backpressure::NONE.
+				 */
+				Backpressure
+				reportEvent(std::shared_ptr<events::Event> event);
+
+				/**
+				 * @brief Step interfaces that have work to do.
+				 */
+				void
+				run();
+
+				/**
+				 * @brief Interface getter.
+				 * @tparam Index index of the interface in the template parameter list.
+				 * @return Reference to the interface.
+				 */
+				template<std::size_t Index>
+				typename std::tuple_element<Index, std::tuple<Interfaces...>>::type &
+				get()
+				{
+					return std::get<Index>(interfaces);
+				}
+			private:
+				std::tuple<Interfaces...> interfaces;
+
+				StaticInterfaceManager(const StaticInterfaceManager&) = delete;
+
+				StaticInterfaceManager&
+				operator=(const StaticInterfaceManager&) = delete;
+
+				static void
+				routeEventPacket(void *context, PacketRef eventPacket, Interface *sourceInterface);
+
+				static Backpressure
+				routeEvent(void *context, std::shared_ptr<events::Event> event);
+
+				template<std::size_t... Index>
+				void
+				bind(std::index_sequence<Index...>);
+
+				template<std::size_t... Index>
+				void
+				initialize(std::index_sequence<Index...>);
+
+				template<std::size_t... Index>
+				Backpressure
+				fanOut(const PacketRef &eventPacket, Interface *sourceInterface, std::index_sequence<Index...>);
+
+				template<std::size_t... Index>
+				void
+				run(std::index_sequence<Index...>);
+
+				template<typename T>
+				static void
+				step(T &interface);
+			};
+		}
+	}
+}
+
+#include <osshs/protocol/interfaces/static_interface_manager_impl.hpp>
+
+#endif  // OSSHS_PROTOCOL_STATIC_INTERFACE_MANAGER_HPP
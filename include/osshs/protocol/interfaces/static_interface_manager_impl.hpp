@@ -0,0 +1,184 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_STATIC_INTERFACE_MANAGER_HPP
+	#error "Don't include this file directly, use 'static_interface_manager.hpp' instead!"
+#endif
+
+#include <osshs/system.hpp>
+#include <osshs/log/logger.hpp>
+#include <osshs/protocol/diagnostics/trace.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			template<typename... Interfaces>
+			StaticInterfaceManager<Interfaces...>::StaticInterfaceManager()
+			{
+				bind(std::index_sequence_for<Interfaces...>());
+			}
+
+			template<typename... Interfaces>
+			void
+			StaticInterfaceManager<Interfaces...>::initialize()
+			{
+				OSSHS_LOG_INFO("Initializing static interface manager.");
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION || OSSHS_PROTOCOL_TRACE
+				diagnostics::CycleCounter::initialize();
+#endif
+
+				initialize(std::index_sequence_for<Interfaces...>());
+			}
+
+			template<typename... Interfaces>
+			Backpressure
+			StaticInterfaceManager<Interfaces...>::reportEventPacket(PacketRef eventPacket, Interface *sourceInterface)
+			{
+				if (eventPacket->isMalformed())
+				{
+					OSSHS_LOG_WARNING("Discarding malformed event packet.");
+
+					if (sourceInterface != nullptr)
+						sourceInterface->statistics.malformedDrops++;
+
+					return Backpressure::NONE;
+				}
+
+				OSSHS_PROTOCOL_TRACE_EVENT_PACKET(EVENT_PACKET_DISPATCHED, eventPacket, 0);
+				OSSHS_PROTOCOL_LATENCY_MARK(eventPacket, DISPATCHED);
+
+				if (sourceInterface != nullptr)
+				{
+					OSSHS_PROTOCOL_LATENCY_RECORD_RECEIVE(sourceInterface, eventPacket);
+				}
+
+				Backpressure backpressure = fanOut(eventPacket, sourceInterface, std::index_sequence_for<Interfaces...>());
+
+				System::reportEvent(eventPacket->getEvent());
+
+				return backpressure;
+			}
+
+			template<typename... Interfaces>
+			Backpressure
+			StaticInterfaceManager<Interfaces...>::reportEvent(std::shared_ptr<events::Event> event)
+			{
+				OSSHS_PROTOCOL_TRACE_EVENT(EVENT_REPORTED, event);
+
+				PacketRef eventPacket = EventPacket::make(
+					event,
+					0x00000000
+				);
+
+				if (eventPacket == nullptr)
+				{
+					OSSHS_LOG_ERROR("Failed to allocate memory for an event packet.");
+					return Backpressure::OVERLOADED;
+				}
+
+				if (eventPacket->isMalformed())
+				{
+					OSSHS_LOG_WARNING("Discarding malformed event packet.");
+					return Backpressure::NONE;
+				}
+
+				return fanOut(eventPacket, nullptr, std::index_sequence_for<Interfaces...>());
+			}
+
+			template<typename... Interfaces>
+			void
+			StaticInterfaceManager<Interfaces...>::run()
+			{
+				run(std::index_sequence_for<Interfaces...>());
+			}
+
+			template<typename... Interfaces>
+			void
+			StaticInterfaceManager<Interfaces...>::routeEventPacket(void *context, PacketRef eventPacket, Interface *sourceInterface)
+			{
+				static_cast<StaticInterfaceManager *>(context)->reportEventPacket(std::move(eventPacket), sourceInterface);
+			}
+
+			template<typename... Interfaces>
+			Backpressure
+			StaticInterfaceManager<Interfaces...>::routeEvent(void *context, std::shared_ptr<events::Event> event)
+			{
+				return static_cast<StaticInterfaceManager *>(context)->reportEvent(std::move(event));
+			}
+
+			template<typename... Interfaces>
+			template<std::size_t... Index>
+			void
+			StaticInterfaceManager<Interfaces...>::bind(std::index_sequence<Index...>)
+			{
+				((std::get<Index>(interfaces).eventPacketRouter = &StaticInterfaceManager::routeEventPacket), ...);
+				((std::get<Index>(interfaces).eventRouter = &StaticInterfaceManager::routeEvent), ...);
+				((std::get<Index>(interfaces).routerContext = this), ...);
+			}
+
+			template<typename... Interfaces>
+			template<std::size_t... Index>
+			void
+			StaticInterfaceManager<Interfaces...>::initialize(std::index_sequence<Index...>)
+			{
+				(std::get<Index>(interfaces).Interfaces::initialize(), ...);
+			}
+
+			template<typename... Interfaces>
+			template<std::size_t... Index>
+			Backpressure
+			StaticInterfaceManager<Interfaces...>::fanOut(const PacketRef &eventPacket, Interface *sourceInterface, std::index_sequence<Index...>)
+			{
+				Backpressure backpressure = Backpressure::NONE;
+
+				((backpressure = worst(backpressure, static_cast<Interface *>(&std::get<Index>(interfaces)) != sourceInterface ?
+					std::get<Index>(interfaces).reportEventPacket(eventPacket) : Backpressure::NONE)), ...);
+
+				return backpressure;
+			}
+
+			template<typename... Interfaces>
+			template<std::size_t... Index>
+			void
+			StaticInterfaceManager<Interfaces...>::run(std::index_sequence<Index...>)
+			{
+				(step(std::get<Index>(interfaces)), ...);
+			}
+
+			template<typename... Interfaces>
+			template<typename T>
+			void
+			StaticInterfaceManager<Interfaces...>::step(T &interface)
+			{
+				// Qualified calls bypass the vtable, letting the compiler inline the interface protothread.
+				if (interface.T::isReady())
+					interface.T::run();
+			}
+		}
+	}
+}
@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_TOKEN_BUCKET_HPP
+#define OSSHS_PROTOCOL_TOKEN_BUCKET_HPP
+
+#include <cstdint>
+#include <modm/platform.hpp>
+#include <osshs/protocol/protocol_config.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			/**
+			 * @brief Byte rate limiter. Tokens refill continuously at the configured rate up to the burst size.
+			 * @note The bucket may go into debt by one packet, so packets larger than the burst size still pass.
+			 */
+			class TokenBucket
+			{
+			public:
+				/**
+				 * @brief Configure the rate limit. The bucket starts full.
+				 * @param bytesPerSecond sustained rate or zero to disable limiting.
+				 * @param burstBytes maximum burst.
+				 */
+				void
+				configure(uint32_t bytesPerSecond, uint32_t burstBytes);
+
+				bool
+				isLimited() const;
+
+				/**
+				 * @brief Check whether a packet may be sent now, without consuming any tokens.
+				 * @return Whether or not the bucket is out of debt.
+				 */
+				bool
+				isConforming() const;
+
+				/**
+				 * @brief Take tokens for a packet that is sent regardless of the current level.
+				 * @param bytes packet length.
+				 */
+				void
+				consume(uint32_t bytes);
+
+				/**
+				 * @brief Take tokens for a packet if the bucket is conforming.
+				 * @param bytes packet length.
+				 * @return Whether or not the packet may pass.
+				 */
+				bool
+				tryConsume(uint32_t bytes);
+
+				/**
+				 * @brief Empty the bucket, so it only holds what refills from now on.
+				 */
+				void
+				drain();
+			private:
+				// Tokens are kept in byte milliseconds, so refilling at byte per second rates never rounds away.
+				int64_t tokens = 0;
+				int64_t capacity = 0;
+				uint32_t rate = 0;
+				modm::Clock::time_point lastRefill;
+
+				void
+				refill();
+			};
+
+			/**
+			 * @brief Token buckets for the most recently seen transmitters, used to police ingress per source mac.
+			 * @note Once all buckets are in use, a new transmitter takes over the bucket of the least recently seen one.
+			 *       Buckets of new transmitters start empty, so forgetting a transmitter never grants it a fresh burst.
+			 */
+			class SourceRateLimiter
+			{
+			public:
+				static constexpr uint8_t SOURCE_COUNT = OSSHS_PROTOCOL_RATE_LIMITER_SOURCES;
+
+				/**
+				 * @brief Configure the per source rate limit. Forgets all tracked sources.
+				 * @param bytesPerSecond sustained rate of every source or zero to disable limiting.
+				 * @param burstBytes maximum burst of every source.
+				 */
+				void
+				configure(uint32_t bytesPerSecond, uint32_t burstBytes);
+
+				/**
+				 * @brief Take tokens for a packet from its source's bucket.
+				 * @param sourceMac transmitter mac of the packet.
+				 * @param bytes packet length.
+				 * @param evicted set if another source was forgotten to make room for this one.
+				 * @return Whether or not the packet may pass.
+				 */
+				bool
+				tryConsume(uint32_t sourceMac, uint32_t bytes, bool &evicted);
+			private:
+				struct Source
+				{
+					uint32_t mac = 0;
+					uint32_t lastSeen = 0;
+					bool used = false;
+					TokenBucket bucket;
+				};
+
+				Source sources[SOURCE_COUNT];
+				uint32_t bytesPerSecond = 0;
+				uint32_t burstBytes = 0;
+				uint32_t seenCount = 0;
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_TOKEN_BUCKET_HPP
@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_USART_HEADER_HPP
+#define OSSHS_PROTOCOL_USART_HEADER_HPP
+
+#include <cstdint>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace usart
+			{
+				/**
+				 * @brief Fragment header policy of USART frames, see docs/USART.md.
+				 * @note USART has no out-of-band identifier, so every frame carries the full header in-band.
+				 */
+				struct UsartHeader
+				{
+					static constexpr uint8_t MTU = 64;
+					static constexpr uint8_t IN_BAND_LENGTH = 4;
+					static constexpr bool ALWAYS_IN_BAND = true;
+
+					static constexpr uint8_t SYNC = 0xa5;
+					static constexpr uint8_t START_FRAME_FLAG = 0x80;
+					static constexpr uint8_t MULTI_FRAME_FLAG = 0x40;
+
+					static void
+					write(uint32_t &, uint8_t *data, bool multiFragment, bool first, uint16_t number, uint8_t payloadLength)
+					{
+						data[0] = SYNC;
+						data[1] = (first ? START_FRAME_FLAG : 0) | (multiFragment ? MULTI_FRAME_FLAG : 0) | ((number >> 8) & 0x0f);
+						data[2] = number & 0xff;
+						data[3] = payloadLength;
+					}
+
+					static bool
+					isMultiFragment(uint32_t, const uint8_t *data)
+					{
+						return data[1] & MULTI_FRAME_FLAG;
+					}
+
+					static bool
+					isFirst(uint32_t, const uint8_t *data)
+					{
+						return data[1] & START_FRAME_FLAG;
+					}
+
+					static uint16_t
+					getNumber(uint32_t, const uint8_t *data)
+					{
+						return ((data[1] & 0x0f) << 8) | data[2];
+					}
+
+					/**
+					 * @brief Get the length of a frame from its in-band header.
+					 * @param data first IN_BAND_LENGTH bytes of the frame.
+					 * @return Frame length, in-band header included. Exceeds MTU for malformed frames.
+					 */
+					static constexpr uint16_t
+					getFrameLength(const uint8_t *data)
+					{
+						return IN_BAND_LENGTH + data[3];
+					}
+
+					static constexpr uint8_t
+					getPaddedLength(uint8_t length)
+					{
+						return length;
+					}
+				};
+			}
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_USART_HEADER_HPP
@@ -0,0 +1,116 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_USART_INTERFACE_HPP
+#define OSSHS_PROTOCOL_USART_INTERFACE_HPP
+
+#include <chrono>
+#include <modm/platform.hpp>
+#include <osshs/protocol/interfaces/interface.hpp>
+#include <osshs/protocol/interfaces/packet_buffer.hpp>
+#include <osshs/protocol/interfaces/fragmenter.hpp>
+#include <osshs/protocol/interfaces/reassembler.hpp>
+#include <osshs/protocol/interfaces/usart/usart_header.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace usart
+			{
+				/**
+				 * @brief Point-to-point interface exchanging USART frames, see docs/USART.md.
+				 * @tparam USART modm style UART providing non-blocking read(uint8_t&) and write(const uint8_t*, size_t) as
+				 *         well as receiveBufferSize() and isWriteFinished().
+				 */
+				template<typename USART>
+				class UsartInterface : public Interface, private modm::NestedResumable<1>
+				{
+				public:
+					/**
+					 * @brief Maximum time between the first and the last byte of a frame and between two frames of a
+					 *        multi frame packet.
+					 */
+					static constexpr std::chrono::milliseconds REASSEMBLY_TIMEOUT = std::chrono::milliseconds(100);
+
+					UsartInterface() = default;
+				protected:
+					bool
+					run();
+
+					bool
+					isReady() const;
+				private:
+					/**
+					 * @brief Maximum number of received bytes handled by a single step.
+					 */
+					static constexpr uint16_t RX_BYTES_PER_STEP = 4 * UsartHeader::MTU;
+
+					PacketRef currentEventPacket;
+					PacketBuffer buffer;
+					Fragmenter<UsartHeader::MTU, UsartHeader> fragmenter;
+					uint8_t txFrame[UsartHeader::MTU];
+					uint8_t txFrameLength = 0;
+					uint8_t txFrameOffset = 0;
+					bool txStalled = false;
+
+					uint8_t rxFrame[UsartHeader::MTU];
+					uint8_t rxFrameLength = 0;
+					modm::Clock::time_point rxFrameStart;
+					Reassembler<UsartHeader::MTU, 1, UsartHeader> reassembler;
+
+					void
+					initialize();
+
+					/**
+					 * @brief Split received bytes into frames and reassemble them into event packets.
+					 * @note Called on every step, so bytes are also received while an event packet is being written.
+					 */
+					void
+					readEventPackets();
+
+					/**
+					 * @brief Reassemble a received frame, routing the event packet it completes.
+					 * @param frame received frame, in-band header included.
+					 * @param length frame length.
+					 */
+					void
+					readFrame(const uint8_t *frame, uint8_t length);
+
+					modm::ResumableResult<void>
+					writeEventPacket(const PacketRef &eventPacket);
+
+					template<typename... Interfaces>
+					friend class interfaces::StaticInterfaceManager;
+				};
+			}
+		}
+	}
+}
+
+#include <osshs/protocol/interfaces/usart/usart_interface_impl.hpp>
+
+#endif  // OSSHS_PROTOCOL_USART_INTERFACE_HPP
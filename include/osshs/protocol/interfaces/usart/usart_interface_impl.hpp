@@ -0,0 +1,287 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2019 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_USART_INTERFACE_HPP
+	#error "Don't include this file directly, use 'usart_interface.hpp' instead!"
+#endif
+
+#include <modm/platform.hpp>
+#include <osshs/resource_lock.hpp>
+#include <osshs/log/logger.hpp>
+#include <osshs/protocol/diagnostics/trace.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace usart
+			{
+				template<typename USART>
+				bool
+				UsartInterface<USART>::run()
+				{
+					readEventPackets();
+
+					PT_BEGIN();
+
+					do
+					{
+						PT_WAIT_UNTIL(isTransmitPending());
+
+						currentEventPacket = std::move(eventPacketQueue.front());
+						eventPacketQueue.pop();
+
+						PT_CALL(writeEventPacket(currentEventPacket));
+
+						currentEventPacket.reset();
+
+						PT_YIELD();
+					}
+					while (true);
+
+					PT_END();
+				}
+
+				template<typename USART>
+				bool
+				UsartInterface<USART>::isReady() const
+				{
+					// A stalled write only resumes once the USART has drained, rather than polling it.
+					bool transmitReady = currentEventPacket != nullptr ? (!txStalled || USART::isWriteFinished()) :
+						(!eventPacketQueue.empty() && !isEgressBlocked());
+
+					return transmitReady || USART::receiveBufferSize() > 0;
+				}
+
+				template<typename USART>
+				void
+				UsartInterface<USART>::initialize()
+				{
+					OSSHS_LOG_INFO("Initializing USART interface.");
+				}
+
+				template<typename USART>
+				void
+				UsartInterface<USART>::readEventPackets()
+				{
+					uint8_t data;
+
+					for (uint16_t i = 0; i < RX_BYTES_PER_STEP && USART::read(data); i++)
+					{
+						if (rxFrameLength > 0 && (modm::Clock::now() - rxFrameStart) > REASSEMBLY_TIMEOUT)
+						{
+							OSSHS_LOG_WARNING("Timed out waiting for the rest of a USART frame.");
+							statistics.reassemblyTimeouts++;
+							rxFrameLength = 0;
+						}
+
+						// Bytes outside of frames are skipped until the next SYNC byte.
+						if (rxFrameLength == 0)
+						{
+							if (data != UsartHeader::SYNC)
+								continue;
+
+							rxFrameStart = modm::Clock::now();
+						}
+
+						rxFrame[rxFrameLength++] = data;
+
+						if (rxFrameLength < UsartHeader::IN_BAND_LENGTH)
+							continue;
+
+						uint16_t frameLength = UsartHeader::getFrameLength(rxFrame);
+
+						if (frameLength > UsartHeader::MTU)
+						{
+							OSSHS_LOG_WARNING("Discarding malformed USART frame.");
+							statistics.malformedDrops++;
+							rxFrameLength = 0;
+							continue;
+						}
+
+						if (rxFrameLength == frameLength)
+						{
+							rxFrameLength = 0;
+							readFrame(rxFrame, frameLength);
+						}
+					}
+				}
+
+				template<typename USART>
+				void
+				UsartInterface<USART>::readFrame(const uint8_t *frame, uint8_t length)
+				{
+					OSSHS_PROTOCOL_LATENCY_CAPTURE(captureTimestamp);
+
+					statistics.framesIn++;
+
+					uint8_t expired = reassembler.expire(REASSEMBLY_TIMEOUT);
+
+					if (expired)
+					{
+						OSSHS_LOG_WARNING("Timed out waiting for frames of a multi frame packet.");
+						statistics.reassemblyTimeouts += expired;
+					}
+
+					// USART links are point-to-point, so frames of a single transmitter are reassembled.
+					switch (reassembler.push(0, 0, frame, length, OSSHS_PROTOCOL_LATENCY_VALUE(captureTimestamp)))
+					{
+						case ReassemblyResult::INCOMPLETE:
+							return;
+						case ReassemblyResult::MALFORMED:
+						case ReassemblyResult::ORPHANED:
+							OSSHS_LOG_WARNING("Discarding malformed USART frame.");
+							statistics.malformedDrops++;
+							return;
+						case ReassemblyResult::NO_MEMORY:
+							OSSHS_LOG_ERROR("Failed to allocate memory for a buffer.");
+							statistics.allocationFailures++;
+							return;
+						case ReassemblyResult::COMPLETE:
+							break;
+					}
+
+					PacketBuffer &completed = reassembler.getCompleted();
+
+					uint16_t bufferLength = completed.getLength();
+
+					diagnostics::Capture::record(
+						captureCallback,
+						diagnostics::CaptureRecordType::EVENT_PACKET,
+						0,
+						0,
+						completed.get(),
+						bufferLength
+					);
+
+					PacketRef eventPacket = EventPacket::make(
+						completed.get(),
+						bufferLength,
+						getEventCallback()
+					);
+
+					completed.release();
+
+					if (eventPacket == nullptr)
+					{
+						OSSHS_LOG_ERROR("Failed to allocate memory for an event packet.");
+						statistics.allocationFailures++;
+						return;
+					}
+
+					if (eventPacket->isMalformed())
+					{
+						OSSHS_LOG_WARNING("Discarding malformed event packet.");
+						statistics.malformedDrops++;
+						return;
+					}
+
+					OSSHS_PROTOCOL_LATENCY_SET(eventPacket, RX_CAPTURE, reassembler.getCompletedTimestamp());
+					OSSHS_PROTOCOL_LATENCY_MARK(eventPacket, REASSEMBLED);
+
+					statistics.packetsIn++;
+					statistics.bytesIn += bufferLength;
+
+					OSSHS_PROTOCOL_TRACE_EVENT_PACKET(USART_EVENT_PACKET_READ, eventPacket, bufferLength);
+
+					routeEventPacket(eventPacket, bufferLength);
+				}
+
+				template<typename USART>
+				modm::ResumableResult<void>
+				UsartInterface<USART>::writeEventPacket(const PacketRef &eventPacket)
+				{
+					RF_BEGIN();
+
+					RF_WAIT_UNTIL(ResourceLock<USART>::tryLock());
+
+					if (!serializeEventPacket(eventPacket, buffer))
+					{
+						OSSHS_LOG_WARNING("Failed to serialize event packet.");
+						ResourceLock<USART>::unlock();
+						RF_RETURN();
+					}
+
+					fragmenter.start(buffer.get(), buffer.getLength());
+
+					while (fragmenter.hasNext())
+					{
+						{
+							uint32_t identifier;
+
+							txFrameLength = fragmenter.next(identifier, txFrame);
+							txFrameOffset = 0;
+						}
+
+						// Frames are written as the USART takes them, without waiting for it to drain.
+						while (true)
+						{
+							txFrameOffset += USART::write(&txFrame[txFrameOffset], txFrameLength - txFrameOffset);
+
+							if (txFrameOffset == txFrameLength)
+								break;
+
+							statistics.txMailboxStalls++;
+							txStalled = true;
+							RF_YIELD();
+							txStalled = false;
+						}
+
+						statistics.framesOut++;
+					}
+
+					{
+						uint16_t bufferLength = buffer.getLength();
+
+						diagnostics::Capture::record(
+							captureCallback,
+							diagnostics::CaptureRecordType::EVENT_PACKET,
+							diagnostics::CaptureRecord::FLAG_TRANSMIT,
+							0,
+							buffer.get(),
+							bufferLength
+						);
+
+						buffer.release();
+
+						statistics.packetsOut++;
+						statistics.bytesOut += bufferLength;
+						egressShaper.consume(bufferLength);
+
+						OSSHS_PROTOCOL_TRACE_EVENT_PACKET(USART_EVENT_PACKET_WRITTEN, eventPacket, bufferLength);
+
+						OSSHS_PROTOCOL_LATENCY_MARK(eventPacket, TX_SENT);
+						OSSHS_PROTOCOL_LATENCY_RECORD_TRANSMIT(this, eventPacket);
+					}
+
+					ResourceLock<USART>::unlock();
+
+					RF_END();
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,135 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_FIXED_POOL_HPP
+#define OSSHS_PROTOCOL_FIXED_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace memory
+		{
+			/**
+			 * @brief Pool of equally sized blocks with O(1) allocation and deallocation from an intrusive free list.
+			 * @note Not interrupt safe, the pool must only be used from the main loop.
+			 * @tparam BlockSize size of a block in bytes.
+			 * @tparam BlockCount number of blocks.
+			 */
+			template<std::size_t BlockSize, std::size_t BlockCount>
+			class FixedPool
+			{
+			public:
+				static constexpr std::size_t BLOCK_SIZE = BlockSize;
+				static constexpr std::size_t BLOCK_COUNT = BlockCount;
+
+				FixedPool()
+				{
+					for (std::size_t i = 0; i < BlockCount - 1; i++)
+						blocks[i].next = &blocks[i + 1];
+
+					blocks[BlockCount - 1].next = nullptr;
+					freeList = &blocks[0];
+				}
+
+				/**
+				 * @brief Allocate a block.
+				 * @return Pointer to the block or nullptr if the pool is exhausted.
+				 */
+				void *
+				allocate()
+				{
+					if (freeList == nullptr)
+						return nullptr;
+
+					Block *block = freeList;
+					freeList = block->next;
+					freeCount--;
+
+					return block->bytes;
+				}
+
+				/**
+				 * @brief Return a block to the pool.
+				 * @param pointer pointer previously returned by allocate() or nullptr.
+				 */
+				void
+				deallocate(void *pointer)
+				{
+					if (pointer == nullptr)
+						return;
+
+					Block *block = static_cast<Block *>(pointer);
+					block->next = freeList;
+					freeList = block;
+					freeCount++;
+				}
+
+				/**
+				 * @brief Check whether a pointer belongs to this pool.
+				 * @param pointer pointer to check.
+				 * @return Whether or not the pointer points into this pool.
+				 */
+				bool
+				owns(const void *pointer) const
+				{
+					return pointer >= static_cast<const void *>(&blocks[0]) &&
+						pointer < static_cast<const void *>(&blocks[BlockCount]);
+				}
+
+				std::size_t
+				getFreeCount() const
+				{
+					return freeCount;
+				}
+
+				bool
+				isExhausted() const
+				{
+					return freeList == nullptr;
+				}
+			private:
+				union Block
+				{
+					Block *next;
+					alignas(std::max_align_t) uint8_t bytes[BlockSize];
+				};
+
+				Block blocks[BlockCount];
+				Block *freeList;
+				std::size_t freeCount = BlockCount;
+
+				FixedPool(const FixedPool&) = delete;
+
+				FixedPool&
+				operator=(const FixedPool&) = delete;
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_FIXED_POOL_HPP
@@ -0,0 +1,170 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_MPSC_QUEUE_HPP
+#define OSSHS_PROTOCOL_MPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace memory
+		{
+			/**
+			 * @brief Bounded lock-free FIFO queue for many producer threads and a single consumer thread.
+			 * @note Every slot carries a sequence number telling producers and the consumer whose turn it is, so
+			 *       producers only contend on claiming a position and never wait for each other to finish writing.
+			 * @tparam T element type.
+			 * @tparam Capacity maximum number of elements, a power of two.
+			 */
+			template<typename T, std::size_t Capacity>
+			class MpscQueue
+			{
+			public:
+				static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "MpscQueue capacity must be a power of two.");
+
+				MpscQueue()
+				{
+					for (std::size_t i = 0; i < Capacity; i++)
+						slots[i].sequence.store(i, std::memory_order_relaxed);
+				}
+
+				~MpscQueue()
+				{
+					T value;
+					while (pop(value));
+				}
+
+				/**
+				 * @brief Append an element. Safe to call from any thread.
+				 * @param value element to append.
+				 * @return Whether or not the element was appended, false if the queue is full.
+				 */
+				bool
+				push(T value)
+				{
+					std::size_t position = tail.load(std::memory_order_relaxed);
+					Slot *slot;
+
+					while (true)
+					{
+						slot = &slots[position & (Capacity - 1)];
+
+						std::intptr_t difference = static_cast<std::intptr_t>(slot->sequence.load(std::memory_order_acquire)) -
+							static_cast<std::intptr_t>(position);
+
+						if (difference == 0)
+						{
+							if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+								break;
+						}
+						else if (difference < 0)
+						{
+							return false;
+						}
+						else
+						{
+							position = tail.load(std::memory_order_relaxed);
+						}
+					}
+
+					new (slot->bytes) T(std::move(value));
+					slot->sequence.store(position + 1, std::memory_order_release);
+
+					return true;
+				}
+
+				/**
+				 * @brief Remove the oldest element. Only call from the consumer thread.
+				 * @param value destination of the removed element.
+				 * @return Whether or not an element was removed, false if the queue is empty.
+				 */
+				bool
+				pop(T &value)
+				{
+					std::size_t position = head.load(std::memory_order_relaxed);
+					Slot &slot = slots[position & (Capacity - 1)];
+
+					if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+						return false;
+
+					T *element = reinterpret_cast<T *>(slot.bytes);
+					value = std::move(*element);
+					element->~T();
+
+					slot.sequence.store(position + Capacity, std::memory_order_release);
+					head.store(position + 1, std::memory_order_relaxed);
+
+					return true;
+				}
+
+				/**
+				 * @brief Get the number of elements. Only a snapshot while producers are active.
+				 * @return Number of elements.
+				 */
+				std::size_t
+				size() const
+				{
+					std::size_t tailPosition = tail.load(std::memory_order_relaxed);
+					std::size_t headPosition = head.load(std::memory_order_relaxed);
+
+					return tailPosition > headPosition ? tailPosition - headPosition : 0;
+				}
+
+				static constexpr std::size_t
+				capacity()
+				{
+					return Capacity;
+				}
+			private:
+				static constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+				struct Slot
+				{
+					std::atomic<std::size_t> sequence;
+					alignas(T) unsigned char bytes[sizeof(T)];
+				};
+
+				Slot slots[Capacity];
+
+				// Producers and the consumer each keep their position on a cache line of their own.
+				alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail{0};
+				alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head{0};
+
+				MpscQueue(const MpscQueue&) = delete;
+
+				MpscQueue&
+				operator=(const MpscQueue&) = delete;
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_MPSC_QUEUE_HPP
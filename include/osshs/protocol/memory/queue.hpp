@@ -0,0 +1,71 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_QUEUE_HPP
+#define OSSHS_PROTOCOL_QUEUE_HPP
+
+#include <queue>
+#include <utility>
+#include <osshs/protocol/protocol_config.hpp>
+#include <osshs/protocol/memory/static_queue.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace memory
+		{
+#if OSSHS_PROTOCOL_STATIC_MEMORY
+			template<typename T>
+			using Queue = StaticQueue<T, OSSHS_PROTOCOL_QUEUE_DEPTH>;
+#else
+			template<typename T>
+			using Queue = std::queue<T>;
+#endif
+
+			/**
+			 * @brief Append an element to a protocol queue.
+			 * @param queue destination queue.
+			 * @param value element to append.
+			 * @return Whether or not the element was appended, false if a static queue is full.
+			 */
+			template<typename T, std::size_t Capacity>
+			bool
+			push(StaticQueue<T, Capacity> &queue, T value)
+			{
+				return queue.push(std::move(value));
+			}
+
+			template<typename T>
+			bool
+			push(std::queue<T> &queue, T value)
+			{
+				queue.push(std::move(value));
+				return true;
+			}
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_QUEUE_HPP
@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_SLAB_ALLOCATOR_HPP
+#define OSSHS_PROTOCOL_SLAB_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <osshs/protocol/protocol_config.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace memory
+		{
+			struct SlabStatistics
+			{
+				uint32_t blockSize = 0;
+				uint32_t blockCount = 0;
+				uint32_t blocksInUse = 0;
+				uint32_t highWaterMark = 0;
+				uint32_t allocations = 0;
+				uint32_t failures = 0;       // Requests this size class could not serve, including oversized ones in the largest class.
+			};
+
+			/**
+			 * @brief Size-class slab pools backing event packets and packet buffers.
+			 * @note Every request is served in O(1) from the smallest size class that fits. Outside of the static memory
+			 *       profile requests an exhausted size class can not serve fall back to the heap.
+			 * @note Not interrupt safe, the pools must only be used from the main loop.
+			 */
+			class SlabAllocator
+			{
+			public:
+				static constexpr uint8_t SIZE_CLASS_COUNT = 5;
+
+				/**
+				 * @brief Allocate a block.
+				 * @param size requested size in bytes.
+				 * @return Pointer to the block or nullptr if no block could be allocated.
+				 */
+				static void *
+				allocate(std::size_t size);
+
+				/**
+				 * @brief Return a block.
+				 * @param pointer pointer previously returned by allocate() or nullptr.
+				 */
+				static void
+				deallocate(void *pointer);
+
+				/**
+				 * @brief Take a snapshot of size class statistics.
+				 * @param sizeClass size class index, from the smallest to the largest.
+				 * @param statistics snapshot destination.
+				 * @return Whether or not a size class with the given index exists.
+				 */
+				static bool
+				getStatistics(uint8_t sizeClass, SlabStatistics &statistics);
+
+				/**
+				 * @brief Reset allocation and failure counters of all size classes.
+				 */
+				static void
+				resetStatistics();
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_SLAB_ALLOCATOR_HPP
@@ -0,0 +1,142 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_STATIC_QUEUE_HPP
+#define OSSHS_PROTOCOL_STATIC_QUEUE_HPP
+
+#include <cstddef>
+#include <utility>
+#include <new>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace memory
+		{
+			/**
+			 * @brief Fixed capacity FIFO queue with a std::queue-like interface.
+			 * @tparam T element type.
+			 * @tparam Capacity maximum number of elements.
+			 */
+			template<typename T, std::size_t Capacity>
+			class StaticQueue
+			{
+			public:
+				static_assert(Capacity > 0, "StaticQueue capacity must be positive.");
+
+				StaticQueue() = default;
+
+				~StaticQueue()
+				{
+					while (!empty())
+						pop();
+				}
+
+				/**
+				 * @brief Append an element.
+				 * @param value element to append.
+				 * @return Whether or not the element was appended, false if the queue is full.
+				 */
+				bool
+				push(T value)
+				{
+					if (full())
+						return false;
+
+					new (&storage[(head + count) % Capacity]) T(std::move(value));
+					count++;
+					return true;
+				}
+
+				/**
+				 * @brief Remove the oldest element. The queue must not be empty.
+				 */
+				void
+				pop()
+				{
+					reinterpret_cast<T *>(&storage[head])->~T();
+					head = (head + 1) % Capacity;
+					count--;
+				}
+
+				/**
+				 * @brief Get the oldest element. The queue must not be empty.
+				 * @return Reference to the oldest element.
+				 */
+				T &
+				front()
+				{
+					return *reinterpret_cast<T *>(&storage[head]);
+				}
+
+				const T &
+				front() const
+				{
+					return *reinterpret_cast<const T *>(&storage[head]);
+				}
+
+				bool
+				empty() const
+				{
+					return count == 0;
+				}
+
+				bool
+				full() const
+				{
+					return count == Capacity;
+				}
+
+				std::size_t
+				size() const
+				{
+					return count;
+				}
+
+				static constexpr std::size_t
+				capacity()
+				{
+					return Capacity;
+				}
+			private:
+				struct alignas(T) Slot
+				{
+					unsigned char bytes[sizeof(T)];
+				};
+
+				Slot storage[Capacity];
+				std::size_t head = 0;
+				std::size_t count = 0;
+
+				StaticQueue(const StaticQueue&) = delete;
+
+				StaticQueue&
+				operator=(const StaticQueue&) = delete;
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_STATIC_QUEUE_HPP
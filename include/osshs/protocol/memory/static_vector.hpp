@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_STATIC_VECTOR_HPP
+#define OSSHS_PROTOCOL_STATIC_VECTOR_HPP
+
+#include <cstddef>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace memory
+		{
+			/**
+			 * @brief Fixed capacity vector of trivially copyable elements with a std::vector-like interface.
+			 * @tparam T element type.
+			 * @tparam Capacity maximum number of elements.
+			 */
+			template<typename T, std::size_t Capacity>
+			class StaticVector
+			{
+			public:
+				/**
+				 * @brief Append an element.
+				 * @param value element to append.
+				 * @return Whether or not the element was appended, false if the vector is full.
+				 */
+				bool
+				push_back(const T &value)
+				{
+					if (count == Capacity)
+						return false;
+
+					elements[count++] = value;
+					return true;
+				}
+
+				T &
+				operator[](std::size_t index)
+				{
+					return elements[index];
+				}
+
+				const T &
+				operator[](std::size_t index) const
+				{
+					return elements[index];
+				}
+
+				T *
+				begin()
+				{
+					return &elements[0];
+				}
+
+				T *
+				end()
+				{
+					return &elements[count];
+				}
+
+				const T *
+				begin() const
+				{
+					return &elements[0];
+				}
+
+				const T *
+				end() const
+				{
+					return &elements[count];
+				}
+
+				std::size_t
+				size() const
+				{
+					return count;
+				}
+
+				bool
+				empty() const
+				{
+					return count == 0;
+				}
+
+				static constexpr std::size_t
+				capacity()
+				{
+					return Capacity;
+				}
+			private:
+				T elements[Capacity] = {};
+				std::size_t count = 0;
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_STATIC_VECTOR_HPP
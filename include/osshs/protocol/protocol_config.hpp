@@ -0,0 +1,245 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_CONFIG_HPP
+#define OSSHS_PROTOCOL_CONFIG_HPP
+
+/*
+ * Compile-time configuration of the protocol layer.
+ * Every option can be overridden by defining it before this header is included (e.g. from the build system).
+ */
+
+/**
+ * @brief Timestamp packets at every stage of their way through the protocol layer and aggregate
+ *        the stage-to-stage latencies into per-interface histograms.
+ * @note When disabled, the instrumentation is removed completely.
+ */
+#ifndef OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+	#define OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION 0
+#endif
+
+/**
+ * @brief Record fixed-size binary trace records of packets passing through the protocol layer into a RAM ring.
+ * @note When disabled, the trace ring and the instrumentation are removed completely.
+ */
+#ifndef OSSHS_PROTOCOL_TRACE
+	#define OSSHS_PROTOCOL_TRACE 0
+#endif
+
+/**
+ * @brief Number of records kept in the trace ring. Must be a power of two.
+ */
+#ifndef OSSHS_PROTOCOL_TRACE_BUFFER_SIZE
+	#define OSSHS_PROTOCOL_TRACE_BUFFER_SIZE 64
+#endif
+
+/**
+ * @brief Put the core to sleep (WFI) from InterfaceManager::run() while no interface has work.
+ * @note Only enable this if the main loop has nothing else to do between interrupts.
+ */
+#ifndef OSSHS_PROTOCOL_IDLE_SLEEP
+	#define OSSHS_PROTOCOL_IDLE_SLEEP 0
+#endif
+
+/**
+ * @brief Draw all protocol-owned storage from statically sized queues and pools instead of the heap.
+ * @note Event payloads are still allocated by the event system, which owns their storage.
+ */
+#ifndef OSSHS_PROTOCOL_STATIC_MEMORY
+	#define OSSHS_PROTOCOL_STATIC_MEMORY 0
+#endif
+
+/**
+ * @brief Default capacity of every per-interface event packet queue, also the upper limit of the capacity and the
+ *        depth of every per-controller queue in the static memory profile.
+ */
+#ifndef OSSHS_PROTOCOL_QUEUE_DEPTH
+	#define OSSHS_PROTOCOL_QUEUE_DEPTH 8
+#endif
+
+/**
+ * @brief Maximum number of interfaces registered with InterfaceManager in the static memory profile.
+ */
+#ifndef OSSHS_PROTOCOL_MAX_INTERFACES
+	#define OSSHS_PROTOCOL_MAX_INTERFACES 4
+#endif
+
+/**
+ * @brief Number of blocks in each slab size class. Event packets and packet buffers are drawn from the smallest
+ *        size class that fits, in the static memory profile the 1024 byte class also bounds the packet size.
+ */
+#ifndef OSSHS_PROTOCOL_SLAB_16_COUNT
+	#define OSSHS_PROTOCOL_SLAB_16_COUNT 8
+#endif
+
+#ifndef OSSHS_PROTOCOL_SLAB_32_COUNT
+	#define OSSHS_PROTOCOL_SLAB_32_COUNT 16
+#endif
+
+#ifndef OSSHS_PROTOCOL_SLAB_64_COUNT
+	#define OSSHS_PROTOCOL_SLAB_64_COUNT 16
+#endif
+
+#ifndef OSSHS_PROTOCOL_SLAB_256_COUNT
+	#define OSSHS_PROTOCOL_SLAB_256_COUNT 4
+#endif
+
+#ifndef OSSHS_PROTOCOL_SLAB_1024_COUNT
+	#define OSSHS_PROTOCOL_SLAB_1024_COUNT 1
+#endif
+
+/**
+ * @brief Size of the per-interface event type subscription bitmap in bits. Must be a power of two of at least 32.
+ */
+#ifndef OSSHS_PROTOCOL_SUBSCRIPTION_BITS
+	#define OSSHS_PROTOCOL_SUBSCRIPTION_BITS 256
+#endif
+
+/**
+ * @brief Number of transmitters tracked by each interface's ingress rate limiter.
+ * @note Raise it if the ingressEvictions statistic keeps growing.
+ */
+#ifndef OSSHS_PROTOCOL_RATE_LIMITER_SOURCES
+	#define OSSHS_PROTOCOL_RATE_LIMITER_SOURCES 8
+#endif
+
+/**
+ * @brief Default nominal CAN bit rate in bits per second, used to estimate bus load.
+ */
+#ifndef OSSHS_PROTOCOL_CAN_BIT_RATE
+	#define OSSHS_PROTOCOL_CAN_BIT_RATE 125000
+#endif
+
+/**
+ * @brief Length of the CAN bus load sliding window in milliseconds and the number of slots it is split into.
+ */
+#ifndef OSSHS_PROTOCOL_BUS_LOAD_WINDOW
+	#define OSSHS_PROTOCOL_BUS_LOAD_WINDOW 100
+#endif
+
+#ifndef OSSHS_PROTOCOL_BUS_LOAD_SLOTS
+	#define OSSHS_PROTOCOL_BUS_LOAD_SLOTS 10
+#endif
+
+/**
+ * @brief Number of packets an interface reassembles at a time, a power of two.
+ */
+#ifndef OSSHS_PROTOCOL_REASSEMBLY_SLOTS
+	#define OSSHS_PROTOCOL_REASSEMBLY_SLOTS 4
+#endif
+
+/**
+ * @brief Number of frames a CAN interface buffers for cut-through forwarding from its peer.
+ */
+#ifndef OSSHS_PROTOCOL_CUT_THROUGH_DEPTH
+	#define OSSHS_PROTOCOL_CUT_THROUGH_DEPTH 16
+#endif
+
+/**
+ * @brief Number of frames a host SocketCAN port receives or sends with a single system call.
+ */
+#ifndef OSSHS_PROTOCOL_SOCKET_BATCH_SIZE
+	#define OSSHS_PROTOCOL_SOCKET_BATCH_SIZE 32
+#endif
+
+/**
+ * @brief Size of the receive and of the transmit buffer of a host serial port in bytes.
+ */
+#ifndef OSSHS_PROTOCOL_SERIAL_BUFFER_SIZE
+	#define OSSHS_PROTOCOL_SERIAL_BUFFER_SIZE 256
+#endif
+
+/**
+ * @brief Run every interface on a worker thread of its own. Host builds only.
+ */
+#ifndef OSSHS_PROTOCOL_THREADED
+	#define OSSHS_PROTOCOL_THREADED 0
+#endif
+
+/**
+ * @brief Number of event packets handed to an interface worker thread that may wait for it, a power of two.
+ */
+#ifndef OSSHS_PROTOCOL_INBOX_DEPTH
+	#define OSSHS_PROTOCOL_INBOX_DEPTH 64
+#endif
+
+/**
+ * @brief Minimum serialized event length in bytes for event packets to be compressed, zero disables compression.
+ * @note Events are only sent compressed when that saves classic CAN frames. Receiving compressed event packets is
+ *       always supported.
+ */
+#ifndef OSSHS_PROTOCOL_COMPRESSION_THRESHOLD
+	#define OSSHS_PROTOCOL_COMPRESSION_THRESHOLD 0
+#endif
+
+/**
+ * @brief Maximum number of queued events an interface merges into a single container packet, one disables merging.
+ * @note Events are merged when they are queued back to back for the same transmitter and receiver, they are never
+ *       held back to wait for others. Receiving container packets is always supported.
+ */
+#ifndef OSSHS_PROTOCOL_CONTAINER_EVENTS
+	#define OSSHS_PROTOCOL_CONTAINER_EVENTS 1
+#endif
+
+/**
+ * @brief Maximum length of a container packet in bytes. Events that would make it longer are sent separately.
+ */
+#ifndef OSSHS_PROTOCOL_CONTAINER_LENGTH
+	#define OSSHS_PROTOCOL_CONTAINER_LENGTH 64
+#endif
+
+/**
+ * @brief Number of tracked requests an interface manager waits for responses to at a time.
+ */
+#ifndef OSSHS_PROTOCOL_PENDING_REQUESTS
+	#define OSSHS_PROTOCOL_PENDING_REQUESTS 8
+#endif
+
+/**
+ * @brief Inline storage of protocol layer callbacks in bytes. Callbacks capturing more state fail to compile.
+ */
+#ifndef OSSHS_PROTOCOL_DELEGATE_CAPACITY
+	#define OSSHS_PROTOCOL_DELEGATE_CAPACITY (2 * sizeof(void *))
+#endif
+
+/**
+ * @brief Use atomic event packet reference counts. Only needed when packets are shared between threads or cores.
+ */
+#ifndef OSSHS_PROTOCOL_ATOMIC_REFERENCE_COUNT
+	#if defined(__arm__)
+		#define OSSHS_PROTOCOL_ATOMIC_REFERENCE_COUNT 0
+	#else
+		#define OSSHS_PROTOCOL_ATOMIC_REFERENCE_COUNT 1
+	#endif
+#endif
+
+#if OSSHS_PROTOCOL_CONTAINER_EVENTS < 1 || OSSHS_PROTOCOL_CONTAINER_EVENTS > 16
+	#error "OSSHS_PROTOCOL_CONTAINER_EVENTS must be between 1 and 16."
+#endif
+
+#if OSSHS_PROTOCOL_THREADED && !OSSHS_PROTOCOL_ATOMIC_REFERENCE_COUNT
+	#error "OSSHS_PROTOCOL_THREADED requires OSSHS_PROTOCOL_ATOMIC_REFERENCE_COUNT."
+#endif
+
+#endif  // OSSHS_PROTOCOL_CONFIG_HPP
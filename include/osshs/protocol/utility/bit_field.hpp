@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_BIT_FIELD_HPP
+#define OSSHS_PROTOCOL_BIT_FIELD_HPP
+
+#include <cstdint>
+#include <type_traits>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace utility
+		{
+			/**
+			 * @brief Compile-time description of a field inside an integer word.
+			 * @tparam T word type.
+			 * @tparam Offset position of the least significant bit of the field.
+			 * @tparam Width field width in bits.
+			 */
+			template<typename T, uint8_t Offset, uint8_t Width>
+			struct BitField
+			{
+				static_assert(std::is_unsigned<T>::value, "Bit fields live in unsigned words.");
+				static_assert(Width > 0 && Offset + Width <= sizeof(T) * 8, "Bit field does not fit into its word.");
+
+				static constexpr uint8_t OFFSET = Offset;
+				static constexpr uint8_t END = Offset + Width;
+				static constexpr T VALUE_MASK = static_cast<T>(Width == sizeof(T) * 8 ? ~T(0) : (T(1) << Width) - 1);
+				static constexpr T MASK = static_cast<T>(VALUE_MASK << Offset);
+
+				static constexpr T
+				get(T word)
+				{
+					return (word >> Offset) & VALUE_MASK;
+				}
+
+				/**
+				 * @brief Replace the field inside a word. Value bits outside the field are dropped.
+				 * @param word word to update.
+				 * @param value new field value.
+				 * @return Updated word.
+				 */
+				static constexpr T
+				set(T word, T value)
+				{
+					return (word & ~MASK) | ((value & VALUE_MASK) << Offset);
+				}
+			};
+
+			/**
+			 * @brief Compile-time description of a little-endian integer field inside a byte buffer.
+			 * @tparam Offset offset of the first byte of the field.
+			 * @tparam Length field length in bytes.
+			 */
+			template<uint16_t Offset, uint8_t Length>
+			struct ByteField
+			{
+				static_assert(Length > 0 && Length <= 4, "Byte fields are up to 4 bytes long.");
+
+				typedef std::conditional_t<Length == 1, uint8_t, std::conditional_t<Length == 2, uint16_t, uint32_t>> Type;
+
+				static constexpr uint16_t OFFSET = Offset;
+				static constexpr uint16_t END = Offset + Length;
+
+				/**
+				 * @brief Read the field. The buffer must be at least END bytes long.
+				 * @param data buffer to read from.
+				 * @return Field value.
+				 */
+				static constexpr Type
+				read(const uint8_t *data)
+				{
+					uint32_t value = 0;
+
+					for (uint8_t i = 0; i < Length; i++)
+						value |= static_cast<uint32_t>(data[Offset + i]) << (i * 8);
+
+					return static_cast<Type>(value);
+				}
+
+				/**
+				 * @brief Write the field. The buffer must be at least END bytes long.
+				 * @param data buffer to write to.
+				 * @param value field value.
+				 */
+				static constexpr void
+				write(uint8_t *data, Type value)
+				{
+					for (uint8_t i = 0; i < Length; i++)
+						data[Offset + i] = static_cast<uint8_t>(value >> (i * 8));
+				}
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_BIT_FIELD_HPP
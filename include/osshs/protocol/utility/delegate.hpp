@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_DELEGATE_HPP
+#define OSSHS_PROTOCOL_DELEGATE_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <osshs/protocol/protocol_config.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace utility
+		{
+			template<typename Signature, std::size_t Capacity = OSSHS_PROTOCOL_DELEGATE_CAPACITY>
+			class Delegate;
+
+			/**
+			 * @brief Callable wrapper with inline storage that never allocates.
+			 * @note Callables whose captures do not fit into the storage are rejected at compile time.
+			 * @tparam R return type.
+			 * @tparam Args argument types.
+			 * @tparam Capacity storage size in bytes.
+			 */
+			template<typename R, typename... Args, std::size_t Capacity>
+			class Delegate<R (Args...), Capacity>
+			{
+			public:
+				Delegate() = default;
+
+				Delegate(std::nullptr_t)
+				{
+				}
+
+				template<typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, Delegate>::value>>
+				Delegate(F &&callable)
+				{
+					typedef std::decay_t<F> Callable;
+
+					static_assert(sizeof(Callable) <= Capacity, "Callable does not fit into the delegate storage, increase OSSHS_PROTOCOL_DELEGATE_CAPACITY.");
+					static_assert(alignof(Callable) <= alignof(std::max_align_t), "Callable is over-aligned for the delegate storage.");
+
+					if (isNull(callable))
+						return;
+
+					new (storage) Callable(std::forward<F>(callable));
+					operations = &OperationsFor<Callable>::operations;
+				}
+
+				Delegate(const Delegate &other)
+				{
+					if (other.operations != nullptr)
+						other.operations->copy(storage, other.storage);
+
+					operations = other.operations;
+				}
+
+				~Delegate()
+				{
+					reset();
+				}
+
+				Delegate &
+				operator=(const Delegate &other)
+				{
+					if (this != &other)
+					{
+						reset();
+
+						if (other.operations != nullptr)
+							other.operations->copy(storage, other.storage);
+
+						operations = other.operations;
+					}
+
+					return *this;
+				}
+
+				Delegate &
+				operator=(std::nullptr_t)
+				{
+					reset();
+					return *this;
+				}
+
+				R
+				operator()(Args... args) const
+				{
+					return operations->invoke(storage, std::forward<Args>(args)...);
+				}
+
+				explicit operator bool() const
+				{
+					return operations != nullptr;
+				}
+
+				bool
+				operator==(std::nullptr_t) const
+				{
+					return operations == nullptr;
+				}
+
+				bool
+				operator!=(std::nullptr_t) const
+				{
+					return operations != nullptr;
+				}
+			private:
+				struct Operations
+				{
+					R (*invoke)(const void *storage, Args&&... args);
+					void (*copy)(void *destination, const void *source);
+					void (*destroy)(void *storage);
+				};
+
+				template<typename Callable>
+				struct OperationsFor
+				{
+					static R
+					invoke(const void *storage, Args&&... args)
+					{
+						return (*const_cast<Callable *>(static_cast<const Callable *>(storage)))(std::forward<Args>(args)...);
+					}
+
+					static void
+					copy(void *destination, const void *source)
+					{
+						new (destination) Callable(*static_cast<const Callable *>(source));
+					}
+
+					static void
+					destroy(void *storage)
+					{
+						static_cast<Callable *>(storage)->~Callable();
+					}
+
+					static constexpr Operations operations = {&invoke, &copy, &destroy};
+				};
+
+				alignas(std::max_align_t) unsigned char storage[Capacity];
+				const Operations *operations = nullptr;
+
+				template<typename F>
+				static bool
+				isNull(const F &callable)
+				{
+					if constexpr (std::is_pointer<F>::value || std::is_member_pointer<F>::value)
+						return callable == nullptr;
+					else
+						return false;
+				}
+
+				void
+				reset()
+				{
+					if (operations != nullptr)
+						operations->destroy(storage);
+
+					operations = nullptr;
+				}
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_DELEGATE_HPP
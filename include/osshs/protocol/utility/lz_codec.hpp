@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef OSSHS_PROTOCOL_LZ_CODEC_HPP
+#define OSSHS_PROTOCOL_LZ_CODEC_HPP
+
+#include <cstdint>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace utility
+		{
+			/**
+			 * @brief LZSS codec with a 256 byte window, in the spirit of heatshrink.
+			 * @note The stream is a sequence of bit-packed, most significant bit first tokens: a 1 bit followed by a
+			 *       literal byte, or a 0 bit followed by the distance minus one (8 bits) and the length minus MIN_MATCH
+			 *       (4 bits) of a back reference. Trailing bits of the last byte are zero. The window is the data
+			 *       already processed, so neither side needs memory beyond the input and output buffers. Compression
+			 *       costs O(length * WINDOW_SIZE * MAX_MATCH) in the worst case, decompression is linear.
+			 */
+			class LzCodec
+			{
+			public:
+				static constexpr uint8_t WINDOW_BITS = 8;
+				static constexpr uint8_t LENGTH_BITS = 4;
+				static constexpr uint16_t WINDOW_SIZE = 1 << WINDOW_BITS;
+				static constexpr uint8_t MIN_MATCH = 2;
+				static constexpr uint8_t MAX_MATCH = MIN_MATCH + (1 << LENGTH_BITS) - 1;
+
+				/**
+				 * @brief Get the longest data a compressed input could decompress to.
+				 * @param inputLength compressed data length.
+				 * @return Maximum decompressed length.
+				 */
+				static constexpr uint32_t
+				getMaxDecompressedLength(uint16_t inputLength)
+				{
+					return static_cast<uint32_t>(inputLength) * 8 / (1 + WINDOW_BITS + LENGTH_BITS) * MAX_MATCH;
+				}
+
+				/**
+				 * @brief Compress data.
+				 * @param input data to compress.
+				 * @param inputLength data length.
+				 * @param output destination buffer.
+				 * @param outputCapacity destination buffer length.
+				 * @return Compressed length or zero if it would not fit into the destination buffer.
+				 */
+				static uint16_t
+				compress(const uint8_t *input, uint16_t inputLength, uint8_t *output, uint16_t outputCapacity);
+
+				/**
+				 * @brief Decompress data of a known length.
+				 * @note Untrusted input is safe to pass, reads and writes never leave the buffers.
+				 * @param input compressed data.
+				 * @param inputLength compressed data length.
+				 * @param output destination buffer.
+				 * @param outputLength exact decompressed length.
+				 * @return Whether or not the input decompressed to exactly outputLength bytes.
+				 */
+				static bool
+				decompress(const uint8_t *input, uint16_t inputLength, uint8_t *output, uint16_t outputLength);
+			};
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_LZ_CODEC_HPP
@@ -1,7 +1,7 @@
 /*
  * MIT License
  *
- * Copyright (c) 2019 Linas Nikiperavicius
+ * Copyright (c) 2020 Linas Nikiperavicius
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy
  * of this software and associated documentation files (the "Software"), to deal
@@ -22,41 +22,31 @@
  * SOFTWARE.
  */
 
-#ifndef OSSHS_PROTOCOL_USART_INTERFACE_HPP
-#define OSSHS_PROTOCOL_USART_INTERFACE_HPP
-
-#include <osshs/protocol/interfaces/interface.hpp>
+#include <osshs/protocol/diagnostics/capture.hpp>
+#include <osshs/protocol/diagnostics/cycle_counter.hpp>
 
 namespace osshs
 {
 	namespace protocol
 	{
-		namespace interfaces
+		namespace diagnostics
 		{
-			namespace usart
+			void
+			Capture::record(const CaptureCallback &callback, CaptureRecordType type, uint8_t flags, uint32_t identifier,
+				const uint8_t *data, uint16_t length)
 			{
-				template<typename USART>
-				class UsartInterface : public Interface, private modm::NestedResumable<1>
-				{
-				public:
-					UsartInterface() = default;
-				protected:
-					bool
-					run();
-				private:
-					std::shared_ptr<EventPacket> currentEventPacket;
+				if (callback == nullptr)
+					return;
 
-					void
-					initialize();
+				CaptureRecord record;
+				record.timestamp = CycleCounter::now();
+				record.identifier = identifier;
+				record.length = length;
+				record.type = type;
+				record.flags = flags;
 
-					modm::ResumableResult<void>
-					writeEventPacket(std::shared_ptr<EventPacket> eventPacket);
-				};
+				callback(record, data);
 			}
 		}
 	}
 }
-
-#include <osshs/protocol/interfaces/usart/usart_interface_impl.hpp>
-
-#endif  // OSSHS_PROTOCOL_USART_INTERFACE_HPP
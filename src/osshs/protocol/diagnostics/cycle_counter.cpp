@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/diagnostics/cycle_counter.hpp>
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+	#define OSSHS_PROTOCOL_HAS_DWT 1
+	#include <modm/platform.hpp>
+#elif defined(__linux__) || defined(__unix__)
+	#define OSSHS_PROTOCOL_HAS_DWT 0
+	#include <chrono>
+#else
+	#define OSSHS_PROTOCOL_HAS_DWT 0
+	#include <modm/platform.hpp>
+#endif
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace diagnostics
+		{
+			void
+			CycleCounter::initialize()
+			{
+#if OSSHS_PROTOCOL_HAS_DWT
+				CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+				DWT->CYCCNT = 0;
+				DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+			}
+
+			uint32_t
+			CycleCounter::now()
+			{
+#if OSSHS_PROTOCOL_HAS_DWT
+				return DWT->CYCCNT;
+#elif defined(__linux__) || defined(__unix__)
+				return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now().time_since_epoch()).count());
+#else
+				return modm::PreciseClock::now().time_since_epoch().count();
+#endif
+			}
+
+			uint32_t
+			CycleCounter::getFrequency()
+			{
+#if OSSHS_PROTOCOL_HAS_DWT
+				return SystemCoreClock;
+#elif defined(__linux__) || defined(__unix__)
+				return 1000000000;
+#else
+				return 1000000;
+#endif
+			}
+		}
+	}
+}
@@ -0,0 +1,135 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/diagnostics/latency_histogram.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace diagnostics
+		{
+			void
+			LatencyTimestamps::set(LatencyStage stage, uint32_t timestamp)
+			{
+				timestamps[static_cast<uint8_t>(stage)] = timestamp;
+				stageMask |= (0b1 << static_cast<uint8_t>(stage));
+			}
+
+			void
+			LatencyTimestamps::mark(LatencyStage stage)
+			{
+				set(stage, CycleCounter::now());
+			}
+
+			bool
+			LatencyTimestamps::has(LatencyStage stage) const
+			{
+				return (stageMask >> static_cast<uint8_t>(stage)) & 0b1;
+			}
+
+			uint32_t
+			LatencyTimestamps::get(LatencyStage stage) const
+			{
+				return timestamps[static_cast<uint8_t>(stage)];
+			}
+
+			void
+			LatencyHistogram::record(uint32_t ticks)
+			{
+				uint8_t bucket = (ticks == 0) ? 0 : (32 - __builtin_clz(ticks));
+
+				buckets[bucket]++;
+				count++;
+
+				if (ticks > max)
+					max = ticks;
+			}
+
+			uint32_t
+			LatencyHistogram::getBucket(uint8_t bucket) const
+			{
+				return bucket < BUCKET_COUNT ? buckets[bucket] : 0;
+			}
+
+			uint32_t
+			LatencyHistogram::getCount() const
+			{
+				return count;
+			}
+
+			uint32_t
+			LatencyHistogram::getMax() const
+			{
+				return max;
+			}
+
+			uint32_t
+			LatencyHistogram::getPercentile(uint8_t percentile) const
+			{
+				uint64_t threshold = (static_cast<uint64_t>(count) * percentile + 99) / 100;
+				uint64_t accumulated = 0;
+
+				for (uint8_t bucket = 0; bucket < BUCKET_COUNT; bucket++)
+				{
+					accumulated += buckets[bucket];
+
+					if (accumulated >= threshold && accumulated > 0)
+						return bucket == 0 ? 0 : static_cast<uint32_t>((static_cast<uint64_t>(1) << bucket) - 1);
+				}
+
+				return max;
+			}
+
+			void
+			LatencyProfile::recordReceive(const LatencyTimestamps &timestamps)
+			{
+				record(LatencyInterval::REASSEMBLY, timestamps, LatencyStage::RX_CAPTURE, LatencyStage::REASSEMBLED);
+				record(LatencyInterval::DISPATCH, timestamps, LatencyStage::REASSEMBLED, LatencyStage::DISPATCHED);
+			}
+
+			void
+			LatencyProfile::recordTransmit(const LatencyTimestamps &timestamps)
+			{
+				record(LatencyInterval::TRANSMIT, timestamps, LatencyStage::TX_ENQUEUED, LatencyStage::TX_SENT);
+				record(LatencyInterval::FORWARD, timestamps, LatencyStage::RX_CAPTURE, LatencyStage::TX_SENT);
+			}
+
+			const LatencyHistogram &
+			LatencyProfile::getHistogram(LatencyInterval interval) const
+			{
+				return histograms[static_cast<uint8_t>(interval)];
+			}
+
+			void
+			LatencyProfile::record(LatencyInterval interval, const LatencyTimestamps &timestamps, LatencyStage from, LatencyStage to)
+			{
+				if (!timestamps.has(from) || !timestamps.has(to))
+					return;
+
+				histograms[static_cast<uint8_t>(interval)].record(timestamps.get(to) - timestamps.get(from));
+			}
+		}
+	}
+}
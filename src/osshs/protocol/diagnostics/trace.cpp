@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/diagnostics/trace.hpp>
+#include <cstring>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace diagnostics
+		{
+			TraceRecord Trace::records[Trace::BUFFER_SIZE];
+			std::atomic<uint32_t> Trace::head(0);
+
+			void
+			Trace::record(TraceEventId eventId, uint8_t flags, uint32_t transmitterMac, uint32_t receiverMac,
+				uint16_t eventType, uint16_t length)
+			{
+				uint32_t index = head.fetch_add(1, std::memory_order_relaxed) & (BUFFER_SIZE - 1);
+
+				TraceRecord &record = records[index];
+				record.timestamp = CycleCounter::now();
+				record.transmitterMac = transmitterMac;
+				record.receiverMac = receiverMac;
+				record.eventType = eventType;
+				record.length = length;
+				record.eventId = eventId;
+				record.flags = flags;
+				record.reserved = 0;
+			}
+
+			std::size_t
+			Trace::dump(uint8_t *buffer, std::size_t bufferLength)
+			{
+				if (bufferLength < sizeof(TraceDumpHeader))
+					return 0;
+
+				uint32_t end = head.load(std::memory_order_relaxed);
+				uint32_t count = end < BUFFER_SIZE ? end : BUFFER_SIZE;
+
+				std::size_t capacity = (bufferLength - sizeof(TraceDumpHeader)) / sizeof(TraceRecord);
+				if (count > capacity)
+					count = capacity;
+
+				TraceDumpHeader header;
+				header.magic = TraceDumpHeader::MAGIC;
+				header.version = TraceDumpHeader::VERSION;
+				header.recordSize = sizeof(TraceRecord);
+				header.frequency = CycleCounter::getFrequency();
+				header.recordCount = count;
+
+				std::memcpy(&buffer[0], &header, sizeof(header));
+
+				std::size_t offset = sizeof(header);
+				for (uint32_t i = end - count; i != end; i++)
+				{
+					std::memcpy(&buffer[offset], &records[i & (BUFFER_SIZE - 1)], sizeof(TraceRecord));
+					offset += sizeof(TraceRecord);
+				}
+
+				return offset;
+			}
+
+			void
+			Trace::clear()
+			{
+				head.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+}
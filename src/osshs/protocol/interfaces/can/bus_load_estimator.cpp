@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/interfaces/can/bus_load_estimator.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace can
+			{
+				BusLoadEstimator::BusLoadEstimator()
+					: currentSlotStart(modm::Clock::now())
+				{
+				}
+
+				void
+				BusLoadEstimator::setBitRate(uint32_t bitRate)
+				{
+					this->bitRate = bitRate;
+				}
+
+				void
+				BusLoadEstimator::setCongestionThresholds(uint16_t highPermille, uint16_t lowPermille)
+				{
+					this->highPermille = highPermille;
+					this->lowPermille = lowPermille;
+				}
+
+				void
+				BusLoadEstimator::recordFrame(uint8_t dataLength, bool extended)
+				{
+					advance();
+
+					uint32_t bits = getFrameBits(dataLength, extended);
+					slotBits[currentSlot] += bits;
+					windowBits += bits;
+				}
+
+				uint16_t
+				BusLoadEstimator::getLoad()
+				{
+					advance();
+
+					if (bitRate == 0)
+						return 0;
+
+					// The current slot is only partially elapsed, so average over the full slots and the elapsed part.
+					uint64_t elapsed = (SLOT_COUNT - 1) * SLOT_DURATION + (modm::Clock::now() - currentSlotStart).count();
+					uint64_t capacity = static_cast<uint64_t>(bitRate) * elapsed / 1000;
+
+					if (capacity == 0)
+						return 0;
+
+					uint64_t load = static_cast<uint64_t>(windowBits) * 1000 / capacity;
+					return load > 1000 ? 1000 : load;
+				}
+
+				bool
+				BusLoadEstimator::isCongested()
+				{
+					uint16_t load = getLoad();
+
+					if (load >= highPermille)
+						congested = true;
+					else if (load < lowPermille)
+						congested = false;
+
+					return congested;
+				}
+
+				void
+				BusLoadEstimator::advance()
+				{
+					modm::Clock::time_point now = modm::Clock::now();
+					uint32_t elapsed = (now - currentSlotStart).count();
+
+					if (elapsed < SLOT_DURATION)
+						return;
+
+					uint32_t slots = elapsed / SLOT_DURATION;
+
+					if (slots >= SLOT_COUNT)
+					{
+						for (uint32_t &bits : slotBits)
+							bits = 0;
+
+						windowBits = 0;
+						currentSlotStart = now;
+						return;
+					}
+
+					for (uint32_t i = 0; i < slots; i++)
+					{
+						currentSlot = (currentSlot + 1) % SLOT_COUNT;
+						windowBits -= slotBits[currentSlot];
+						slotBits[currentSlot] = 0;
+					}
+
+					currentSlotStart += modm::Clock::duration(slots * SLOT_DURATION);
+				}
+			}
+		}
+	}
+}
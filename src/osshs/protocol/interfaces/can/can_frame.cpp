@@ -23,6 +23,7 @@
  */
 
 #include <osshs/protocol/interfaces/can/can_frame.hpp>
+#include <algorithm>
 
 namespace osshs
 {
@@ -33,47 +34,42 @@ namespace osshs
 			namespace can
 			{
 				CanFrame::CanFrame(const uint8_t *data, uint8_t dataLen, uint16_t transmitterMac,
-						uint16_t lastFrameId = 0, uint16_t frameId = 0, bool error = false)
+						uint16_t lastFrameId, uint16_t frameId, bool error)
 				{
 					if (lastFrameId == 0)
 					{
-						uint8_t *buffer = new uint8_t[dataLen];
-						std::copy(&data[0], &data[dataLen], &buffer[0]);
+						dataLen = std::min<uint8_t>(dataLen, MAX_DATA_LENGTH);
+						std::copy(&data[0], &data[dataLen], &this->data[0]);
 
-						this->data = std::unique_ptr<const uint8_t[]>(buffer);
 						this->dataLen = dataLen;
 					}
 					else
 					{
-						uint8_t *buffer = new uint8_t[dataLen + 1];
-						buffer[0] = frameId > 0 ? frameId & 0x0ff : lastFrameId & 0x0ff;
-						std::copy(&data[0], &data[dataLen], &buffer[1]);
-						
-						this->data = std::unique_ptr<const uint8_t[]>(buffer);
+						dataLen = std::min<uint8_t>(dataLen, MAX_DATA_LENGTH - 1);
+						this->data[0] = frameId > 0 ? frameId & 0x0ff : lastFrameId & 0x0ff;
+						std::copy(&data[0], &data[dataLen], &this->data[1]);
+
 						this->dataLen = dataLen + 1;
 					}
 
-					extendedIdentifier = 0x00000000;
-					extendedIdentifier |= (static_cast<uint8_t>(!error)) << 28; // NOT_ERROR_FLAG
-					extendedIdentifier |= (static_cast<uint8_t>(frameId == 0)) << 27; // START_FRAME_FLAG
-					extendedIdentifier |= (static_cast<uint8_t>(lastFrameId > 0)) << 26; // MULTI_FRAME_FLAG
-					extendedIdentifier |= (frameId > 0 ? frameId & 0xf00 : lastFrameId & 0xf00) << 16; // FRAME_COUNT / FRAME_ID
-					extendedIdentifier |= transmitterMac; // TRANSMITTER_MAC
+					extendedIdentifier = CanIdentifier::encode(transmitterMac, lastFrameId > 0, frameId == 0,
+						frameId > 0 ? frameId : lastFrameId, error);
 				}
 
 				CanFrame::CanFrame(const modm::can::Message &message)
 				{
-					data = std::unique_ptr<const uint8_t[]>(message.data);
-					dataLen = message.getLength();
+					dataLen = std::min<uint8_t>(message.getLength(), MAX_DATA_LENGTH);
+					std::copy(&message.data[0], &message.data[dataLen], &data[0]);
+
 					extendedIdentifier = message.getIdentifier();
 				}
 
-				std::unique_ptr<modm::can::Message>
-				CanFrame::getMessage()
+				modm::can::Message
+				CanFrame::getMessage() const
 				{
-					std::unique_ptr message(new modm::can::Message(extendedIdentifier, dataLen);
-					message->setExtended(true);
-					std::copy(&data[0], &data[dataLen], &message->data[0]);
+					modm::can::Message message(extendedIdentifier, dataLen);
+					message.setExtended(true);
+					std::copy(&data[0], &data[dataLen], &message.data[0]);
 
 					return message;
 				}
@@ -91,7 +87,7 @@ namespace osshs
 				CanFrame::getDataLen()
 				{
 					if (isMultiFrame())
-						return dataLen - 1;
+						return dataLen ? dataLen - 1 : 0;
 
 					return dataLen;
 				}
@@ -105,25 +101,28 @@ namespace osshs
 				uint16_t
 				CanFrame::getTransmitterMac()
 				{
-					return extendedIdentifier & 0xffff;
+					return CanIdentifier::TransmitterMac::get(extendedIdentifier);
 				}
 
 				uint16_t
 				CanFrame::getFrameId()
 				{
-					return ((extendedIdentifier >> 8) & 0x0f00) | data[0];
+					if (!isMultiFrame() || dataLen == 0)
+						return 0;
+
+					return CanIdentifier::getFrameId(extendedIdentifier, data);
 				}
 
 				bool
 				CanFrame::isError()
 				{
-					return (extendedIdentifier >> 28) & 0b1 == 0;
+					return !CanIdentifier::NotErrorFlag::get(extendedIdentifier);
 				}
 
 				bool
 				CanFrame::isMultiFrame()
 				{
-					return (extendedIdentifier >> 26) & 0b1 == 1;
+					return CanIdentifier::MultiFrameFlag::get(extendedIdentifier);
 				}
 			}
 		}
@@ -25,6 +25,9 @@
 #include <osshs/protocol/interfaces/event_packet.hpp>
 #include <osshs/events/event_factory.hpp>
 #include <osshs/log/logger.hpp>
+#include <osshs/protocol/utility/lz_codec.hpp>
+#include <osshs/protocol/interfaces/fragmenter.hpp>
+#include <osshs/protocol/interfaces/can/can_header.hpp>
 
 namespace osshs
 {
@@ -32,46 +35,108 @@ namespace osshs
 	{
 		namespace interfaces
 		{
-			EventPacket::EventPacket(std::unique_ptr<const uint8_t[]> data, events::EventCallback callback)
+			void
+			EventPacket::destroy(EventPacket *eventPacket)
 			{
-				multiTarget = (data[2] >> 7) & 0b1;
-				command = (data[2] >> 6) & 0b1;
+				eventPacket->~EventPacket();
+				memory::SlabAllocator::deallocate(eventPacket);
+			}
+
+			EventPacket::EventPacket(const uint8_t *data, uint16_t length, const events::EventCallback &callback)
+			{
+				PacketHeader::Fields fields;
+
+				if (!PacketHeader::decode(data, length, fields))
+				{
+					OSSHS_LOG_WARNING("Failed to decode event packet header(length = %u).", length);
+
+					multiTarget = false;
+					command = false;
+					transmitterMac = NULL_MAC;
+					receiverMac = NULL_MAC;
+					requestId = PacketHeader::NO_REQUEST_ID;
+					return;
+				}
+
+				decodeEvent(data, fields, callback);
 
-				transmitterMac = data[3] | (data[4] << 8) | (data[5] << 16) | (data[6] << 24);
+				if (event == nullptr)
+					return;
 
-				uint8_t *serializedEvent;
+				PacketRef *tail = &next;
 
-				if (multiTarget)
+				while (PacketHeader::nextEvent(data, fields))
 				{
-					uint16_t eventLength = data[7] | (data[8] << 8);
-					serializedEvent = new (std::nothrow) uint8_t[eventLength];
+					*tail = EventPacket::make(data, fields, callback);
+
+					if (*tail == nullptr)
+					{
+						OSSHS_LOG_ERROR("Failed to allocate memory for an event packet.");
+						return;
+					}
 
-					if (serializedEvent == nullptr)
+					if ((*tail)->isMalformed())
 					{
-						OSSHS_LOG_ERROR("Failed to allocate memory for a buffer(bufferLength = %u).", eventLength);
+						tail->reset();
 						return;
 					}
 
-					std::copy(&data[7], &data[7 + eventLength], &serializedEvent[0]);
+					tail = &(*tail)->next;
 				}
-				else
+			}
+
+			EventPacket::EventPacket(const uint8_t *data, const PacketHeader::Fields &fields, const events::EventCallback &callback)
+			{
+				decodeEvent(data, fields, callback);
+			}
+
+			void
+			EventPacket::decodeEvent(const uint8_t *data, const PacketHeader::Fields &fields, const events::EventCallback &callback)
+			{
+				multiTarget = fields.multiTarget;
+				command = fields.command;
+				transmitterMac = fields.transmitterMac;
+				receiverMac = fields.receiverMac;
+				requestId = fields.requestId;
+
+				uint16_t compressedOffset = fields.eventOffset + PacketHeader::MIN_EVENT_LENGTH;
+
+				// Reject lengths no compressed event of this size could expand to before allocating for them.
+				if (fields.compressed && static_cast<uint32_t>(fields.eventLength - PacketHeader::MIN_EVENT_LENGTH) >
+					utility::LzCodec::getMaxDecompressedLength(fields.packetLength - compressedOffset))
 				{
-					transmitterMac = data[7] | (data[8] << 8) | (data[9] << 16) | (data[10] << 24);
+					OSSHS_LOG_WARNING("Compressed event length is out of range(packetLength = %u, eventLength = %u).", fields.packetLength, fields.eventLength);
+					return;
+				}
 
-					uint16_t eventLength = data[11] | (data[12] << 8);
-					serializedEvent = new (std::nothrow) uint8_t[eventLength];
+				uint8_t *serializedEvent = new (std::nothrow) uint8_t[fields.eventLength];
 
-					if (serializedEvent == nullptr)
+				if (serializedEvent == nullptr)
+				{
+					OSSHS_LOG_ERROR("Failed to allocate memory for a buffer(bufferLength = %u).", fields.eventLength);
+					return;
+				}
+
+				if (fields.compressed)
+				{
+					// Only the event length and type are stored uncompressed.
+					std::copy(&data[fields.eventOffset], &data[compressedOffset], &serializedEvent[0]);
+
+					if (!utility::LzCodec::decompress(&data[compressedOffset], fields.packetLength - compressedOffset,
+						&serializedEvent[PacketHeader::MIN_EVENT_LENGTH], fields.eventLength - PacketHeader::MIN_EVENT_LENGTH))
 					{
-						OSSHS_LOG_ERROR("Failed to allocate memory for a buffer(bufferLength = %u).", eventLength);
+						OSSHS_LOG_WARNING("Failed to decompress event(packetLength = %u, eventLength = %u).", fields.packetLength, fields.eventLength);
+
+						delete[] serializedEvent;
 						return;
 					}
-
-					std::copy(&data[11], &data[11 + eventLength], &serializedEvent[0]);
+				}
+				else
+				{
+					std::copy(&data[fields.eventOffset], &data[fields.eventOffset + fields.eventLength], &serializedEvent[0]);
 				}
 
-				uint16_t eventType = serializedEvent[2] | (serializedEvent[3] << 8);
-				event = events::EventFactory::make(eventType, std::unique_ptr<const uint8_t[]>(serializedEvent), callback);
+				event = events::EventFactory::make(fields.eventType, std::unique_ptr<const uint8_t[]>(serializedEvent), callback);
 			}
 
 			bool
@@ -98,76 +163,194 @@ namespace osshs
 				return receiverMac;
 			}
 
+			uint16_t
+			EventPacket::getRequestId() const
+			{
+				return requestId;
+			}
+
 			std::shared_ptr<events::Event>
 			EventPacket::getEvent() const
 			{
 				return event;
 			}
 
+			uint16_t
+			EventPacket::getEventType() const
+			{
+				return event->getType();
+			}
+
 			bool
 			EventPacket::isMalformed() const
 			{
 				return event == nullptr;
 			}
 
+			bool
+			EventPacket::isMergeableWith(const EventPacket &other) const
+			{
+				// Request ids live in the header, so tracked requests and responses always travel alone.
+				return requestId == PacketHeader::NO_REQUEST_ID &&
+					other.requestId == PacketHeader::NO_REQUEST_ID &&
+					multiTarget == other.multiTarget &&
+					command == other.command &&
+					transmitterMac == other.transmitterMac &&
+					(multiTarget || receiverMac == other.receiverMac);
+			}
+
+			PacketRef
+			EventPacket::takeNext()
+			{
+				return std::move(next);
+			}
+
 			std::unique_ptr<const uint8_t[]>
 			EventPacket::serialize() const
+			{
+				uint8_t *buffer = nullptr;
+
+				serialize([](void *context, uint16_t packetLength) -> uint8_t * {
+					uint8_t *&buffer = *static_cast<uint8_t **>(context);
+					buffer = new (std::nothrow) uint8_t[packetLength];
+
+					if (buffer == nullptr)
+						OSSHS_LOG_ERROR("Failed to allocate memory for a buffer(bufferLength = %u).", packetLength);
+
+					return buffer;
+				}, &buffer);
+
+				return std::unique_ptr<const uint8_t[]>(buffer);
+			}
+
+			uint16_t
+			EventPacket::serialize(uint8_t *buffer, uint16_t bufferLength) const
+			{
+				struct Destination
+				{
+					uint8_t *buffer;
+					uint16_t bufferLength;
+				} destination = {buffer, bufferLength};
+
+				return serialize([](void *context, uint16_t packetLength) -> uint8_t * {
+					Destination &destination = *static_cast<Destination *>(context);
+
+					if (packetLength > destination.bufferLength)
+					{
+						OSSHS_LOG_WARNING("Event packet does not fit into the buffer(packetLength = %u, bufferLength = %u).", packetLength, destination.bufferLength);
+						return nullptr;
+					}
+
+					return destination.buffer;
+				}, &destination);
+			}
+
+			uint16_t
+			EventPacket::serialize(SerializationBufferProvider bufferProvider, void *context) const
 			{
 				std::unique_ptr<const uint8_t[]> serializedEvent = event->serialize();
 
 				if (serializedEvent == nullptr)
 				{
 					OSSHS_LOG_WARNING("Failed to serialize event.");
-					return std::unique_ptr<const uint8_t[]>();
+					return 0;
 				}
 
-				uint16_t eventLength = serializedEvent[0] | (serializedEvent[1] << 8);
+				return serializeEvent(serializedEvent.get(), bufferProvider, context);
+			}
+
+			uint16_t
+			EventPacket::serializeEvent(const uint8_t *serializedEvent, SerializationBufferProvider bufferProvider, void *context) const
+			{
+				uint16_t eventLength = PacketHeader::EventLength::read(serializedEvent);
 
-				uint16_t packetLength = multiTarget ? (eventLength + 7) : (eventLength + 11);
+				uint16_t packetLength = PacketHeader::getHeaderLength(multiTarget, requestId != PacketHeader::NO_REQUEST_ID) + eventLength;
 
-				uint8_t *buffer = new (std::nothrow) uint8_t[packetLength];
+				uint8_t *buffer = bufferProvider(context, packetLength);
 
 				if (buffer == nullptr)
+					return 0;
+
+				uint16_t eventOffset = packetLength - eventLength;
+
+#if OSSHS_PROTOCOL_COMPRESSION_THRESHOLD
+				if (eventLength >= OSSHS_PROTOCOL_COMPRESSION_THRESHOLD && eventLength > PacketHeader::MIN_EVENT_LENGTH + 1)
 				{
-					OSSHS_LOG_ERROR("Failed to allocate memory for a buffer(bufferLength = %u).", packetLength);
-					return std::unique_ptr<const uint8_t[]>();
-				}
+					uint16_t compressedOffset = eventOffset + PacketHeader::MIN_EVENT_LENGTH;
+					uint16_t uncompressedLength = eventLength - PacketHeader::MIN_EVENT_LENGTH;
 
-				buffer[0] = packetLength & 0xff;
-				buffer[1] = (packetLength >> 8);
+					// The buffer holds the uncompressed packet, so compression has to save at least one byte to fit.
+					uint16_t compressedLength = utility::LzCodec::compress(&serializedEvent[PacketHeader::MIN_EVENT_LENGTH],
+						uncompressedLength, &buffer[compressedOffset], uncompressedLength - 1);
 
-				buffer[2]  = (multiTarget << 7);
-				buffer[2] |= (command << 6);
-				buffer[2] |= (0b0 << 5);
-				buffer[2] |= (0b0 << 4);
-				buffer[2] |= (0b0 << 3);
-				buffer[2] |= (0b0 << 2);
-				buffer[2] |= (0b0 << 1);
-				buffer[2] |= (0b0 << 0);
+					// Receivers pay for decompression, so it is only worth it if it saves frames on the bus. Classic CAN
+					// frames are the smallest the protocol is carried in, so they are saved first.
+					typedef Fragmenter<can::ClassicCanHeader::MTU, can::ClassicCanHeader> CanFragmenter;
 
-				buffer[3] = transmitterMac & 0xff;
-				buffer[4] = (transmitterMac >> 8) & 0xff;
-				buffer[5] = (transmitterMac >> 16) & 0xff;
-				buffer[6] = (transmitterMac >> 24);
+					if (compressedLength != 0 && CanFragmenter::getFragmentCount(compressedOffset + compressedLength) <
+						CanFragmenter::getFragmentCount(packetLength))
+					{
+						packetLength = compressedOffset + compressedLength;
 
-				if (multiTarget)
-				{
-					for (uint16_t i = 0; i < eventLength; i++)
-						buffer[7 + i] = serializedEvent[i];
+						writeHeader(buffer, packetLength, true);
+						std::copy(&serializedEvent[0], &serializedEvent[PacketHeader::MIN_EVENT_LENGTH], &buffer[eventOffset]);
+
+						return packetLength;
+					}
 				}
-				else
+#endif
+
+				writeHeader(buffer, packetLength);
+				std::copy(&serializedEvent[0], &serializedEvent[eventLength], &buffer[eventOffset]);
+
+				return packetLength;
+			}
+
+			uint16_t
+			EventPacket::serializeContainer(const std::unique_ptr<const uint8_t[]> *events, uint8_t eventCount,
+				SerializationBufferProvider bufferProvider, void *context) const
+			{
+				if (eventCount == 1)
+					return serializeEvent(events[0].get(), bufferProvider, context);
+
+				uint16_t packetLength = PacketHeader::getHeaderLength(multiTarget);
+
+				for (uint8_t i = 0; i < eventCount; i++)
+					packetLength += PacketHeader::EventLength::read(events[i].get());
+
+				uint8_t *buffer = bufferProvider(context, packetLength);
+
+				if (buffer == nullptr)
+					return 0;
+
+				writeHeader(buffer, packetLength, false, true);
+
+				uint16_t eventOffset = PacketHeader::getHeaderLength(multiTarget);
+
+				for (uint8_t i = 0; i < eventCount; i++)
 				{
-					buffer[7] = receiverMac & 0xff;
-					buffer[8] = (receiverMac >> 8) & 0xff;
-					buffer[9] = (receiverMac >> 16) & 0xff;
-					buffer[10] = (receiverMac >> 24);
+					uint16_t eventLength = PacketHeader::EventLength::read(events[i].get());
 
-					for (uint16_t i = 0; i < eventLength; i++)
-						buffer[11 + i] = serializedEvent[i];
+					std::copy(&events[i][0], &events[i][eventLength], &buffer[eventOffset]);
+					eventOffset += eventLength;
 				}
 
-				return std::unique_ptr<const uint8_t[]>(buffer);
+				return packetLength;
+			}
+
+			void
+			EventPacket::writeHeader(uint8_t *buffer, uint16_t packetLength, bool compressed, bool container) const
+			{
+				PacketHeader::encode(buffer, packetLength, multiTarget, command, transmitterMac, receiverMac, compressed, container, requestId);
+			}
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+			diagnostics::LatencyTimestamps &
+			EventPacket::getLatencyTimestamps()
+			{
+				return latencyTimestamps;
 			}
+#endif
 		}
 	}
 }
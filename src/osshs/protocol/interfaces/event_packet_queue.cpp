@@ -0,0 +1,208 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <osshs/protocol/interfaces/event_packet_queue.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			EventPacketQueue::EventPacketQueue()
+#if !OSSHS_PROTOCOL_STATIC_MEMORY
+				: slots(OSSHS_PROTOCOL_QUEUE_DEPTH)
+#endif
+			{
+			}
+
+			bool
+			EventPacketQueue::configure(std::size_t capacity, DropPolicy dropPolicy, bool coalescing)
+			{
+#if OSSHS_PROTOCOL_STATIC_MEMORY
+				if (capacity == 0 || capacity > OSSHS_PROTOCOL_QUEUE_DEPTH)
+					return false;
+#else
+				if (capacity == 0)
+					return false;
+#endif
+
+				while (count > capacity)
+					pop();
+
+				// Straighten the ring, so the queued event packets stay in order under the new capacity.
+				PacketRef *first = &slots[0];
+				std::rotate(first, first + head, first + limit);
+				head = 0;
+
+#if !OSSHS_PROTOCOL_STATIC_MEMORY
+				slots.resize(capacity);
+#endif
+
+				limit = capacity;
+				this->dropPolicy = dropPolicy;
+				this->coalescing = coalescing;
+
+				return true;
+			}
+
+			QueueResult
+			EventPacketQueue::push(PacketRef eventPacket)
+			{
+				// Only the latest state has to cross the bus, a stale sample still waiting for transmission is replaced.
+				if (coalescing && replace(eventPacket, true))
+					return QueueResult::COALESCED;
+
+				if (count < limit)
+				{
+					at(count) = std::move(eventPacket);
+					count++;
+
+					return QueueResult::QUEUED;
+				}
+
+				if (dropPolicy == DropPolicy::COALESCE_BY_TYPE && replace(eventPacket, false))
+					return QueueResult::COALESCED;
+
+				if (dropPolicy == DropPolicy::DROP_NEWEST && !eventPacket->isCommand())
+					return QueueResult::REJECTED;
+
+				if (!eraseOldestNonCommand())
+					return QueueResult::REJECTED;
+
+				at(count) = std::move(eventPacket);
+				count++;
+
+				return QueueResult::DROPPED_OLDEST;
+			}
+
+			void
+			EventPacketQueue::pop()
+			{
+				at(0).reset();
+				head = (head + 1) % limit;
+				count--;
+			}
+
+			PacketRef &
+			EventPacketQueue::front()
+			{
+				return at(0);
+			}
+
+			const PacketRef &
+			EventPacketQueue::front() const
+			{
+				return at(0);
+			}
+
+			bool
+			EventPacketQueue::empty() const
+			{
+				return count == 0;
+			}
+
+			std::size_t
+			EventPacketQueue::size() const
+			{
+				return count;
+			}
+
+			std::size_t
+			EventPacketQueue::capacity() const
+			{
+				return limit;
+			}
+
+			bool
+			EventPacketQueue::isCongested() const
+			{
+				return count * 4 >= limit * 3;
+			}
+
+			PacketRef &
+			EventPacketQueue::at(std::size_t index)
+			{
+				return slots[(head + index) % limit];
+			}
+
+			const PacketRef &
+			EventPacketQueue::at(std::size_t index) const
+			{
+				return slots[(head + index) % limit];
+			}
+
+			void
+			EventPacketQueue::erase(std::size_t index)
+			{
+				for (std::size_t i = index; i + 1 < count; i++)
+					at(i) = std::move(at(i + 1));
+
+				at(count - 1).reset();
+				count--;
+			}
+
+			bool
+			EventPacketQueue::eraseOldestNonCommand()
+			{
+				for (std::size_t i = 0; i < count; i++)
+				{
+					if (!at(i)->isCommand())
+					{
+						erase(i);
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			bool
+			EventPacketQueue::replace(PacketRef &eventPacket, bool matchSource)
+			{
+				// Responses answer distinct requests, even when they carry the same state.
+				if (eventPacket->isCommand() || eventPacket->getRequestId() != PacketHeader::NO_REQUEST_ID)
+					return false;
+
+				for (std::size_t i = 0; i < count; i++)
+				{
+					PacketRef &queued = at(i);
+
+					if (!queued->isCommand() &&
+						queued->getRequestId() == PacketHeader::NO_REQUEST_ID &&
+						queued->getEventType() == eventPacket->getEventType() &&
+						queued->getReceiverMac() == eventPacket->getReceiverMac() &&
+						(!matchSource || queued->getTransmitterMac() == eventPacket->getTransmitterMac()))
+					{
+						queued = std::move(eventPacket);
+						return true;
+					}
+				}
+
+				return false;
+			}
+		}
+	}
+}
@@ -0,0 +1,254 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/interfaces/host/capture_file.hpp>
+
+#if defined(__linux__)
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <osshs/log/logger.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				static constexpr std::size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+				CaptureWriter::~CaptureWriter()
+				{
+					close();
+				}
+
+				bool
+				CaptureWriter::open(const char *path)
+				{
+					close();
+
+					std::FILE *newFile = std::fopen(path, "wb");
+					if (newFile == nullptr)
+					{
+						OSSHS_LOG_ERROR("Failed to create capture file.");
+						return false;
+					}
+
+					std::setvbuf(newFile, nullptr, _IOFBF, WRITE_BUFFER_SIZE);
+
+					diagnostics::CaptureFileHeader header;
+					header.magic = diagnostics::CaptureFileHeader::MAGIC;
+					header.version = diagnostics::CaptureFileHeader::VERSION;
+					header.recordSize = sizeof(diagnostics::CaptureRecord);
+					header.frequency = 1000000000;
+					header.reserved = 0;
+
+					if (std::fwrite(&header, sizeof(header), 1, newFile) != 1)
+					{
+						OSSHS_LOG_ERROR("Failed to write capture file header.");
+						std::fclose(newFile);
+						return false;
+					}
+
+					std::lock_guard<std::mutex> lock(mutex);
+
+					file = newFile;
+					start = std::chrono::steady_clock::now();
+					recordCount = 0;
+
+					return true;
+				}
+
+				void
+				CaptureWriter::close()
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+
+					if (file == nullptr)
+						return;
+
+					std::fclose(file);
+					file = nullptr;
+				}
+
+				bool
+				CaptureWriter::isOpen() const
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+
+					return file != nullptr;
+				}
+
+				void
+				CaptureWriter::write(const diagnostics::CaptureRecord &record, const uint8_t *data)
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+
+					if (file == nullptr)
+						return;
+
+					diagnostics::CaptureRecord stamped = record;
+					stamped.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+						std::chrono::steady_clock::now() - start).count();
+
+					std::fwrite(&stamped, sizeof(stamped), 1, file);
+					std::fwrite(data, 1, record.length, file);
+					recordCount++;
+				}
+
+				diagnostics::CaptureCallback
+				CaptureWriter::getCallback(uint8_t channel)
+				{
+					return [this, channel](const diagnostics::CaptureRecord &record, const uint8_t *data)
+					{
+						diagnostics::CaptureRecord channelRecord = record;
+						channelRecord.flags = (record.flags & ~diagnostics::CaptureRecord::CHANNEL_MASK) |
+							(channel & diagnostics::CaptureRecord::CHANNEL_MASK);
+
+						write(channelRecord, data);
+					};
+				}
+
+				bool
+				CaptureWriter::flush()
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+
+					return file != nullptr && std::fflush(file) == 0;
+				}
+
+				uint64_t
+				CaptureWriter::getRecordCount() const
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+
+					return recordCount;
+				}
+
+				CaptureFile::~CaptureFile()
+				{
+					close();
+				}
+
+				bool
+				CaptureFile::open(const char *path)
+				{
+					close();
+
+					int fileDescriptor = ::open(path, O_RDONLY | O_CLOEXEC);
+					if (fileDescriptor < 0)
+					{
+						OSSHS_LOG_ERROR("Failed to open capture file.");
+						return false;
+					}
+
+					struct stat status;
+					if (fstat(fileDescriptor, &status) < 0 || static_cast<std::size_t>(status.st_size) < sizeof(header))
+					{
+						OSSHS_LOG_ERROR("Capture file is too short.");
+						::close(fileDescriptor);
+						return false;
+					}
+
+					void *mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+					::close(fileDescriptor);
+
+					if (mapping == MAP_FAILED)
+					{
+						OSSHS_LOG_ERROR("Failed to map capture file.");
+						return false;
+					}
+
+					// Records are read front to back exactly once. Advice values are not flags, so they are given one by one.
+					madvise(mapping, status.st_size, MADV_SEQUENTIAL);
+					madvise(mapping, status.st_size, MADV_WILLNEED);
+
+					map = static_cast<const uint8_t *>(mapping);
+					size = status.st_size;
+					std::memcpy(&header, map, sizeof(header));
+
+					if (header.magic != diagnostics::CaptureFileHeader::MAGIC ||
+						header.version != diagnostics::CaptureFileHeader::VERSION ||
+						header.recordSize != sizeof(diagnostics::CaptureRecord) ||
+						header.frequency == 0)
+					{
+						OSSHS_LOG_ERROR("Unsupported capture file.");
+						close();
+						return false;
+					}
+
+					return true;
+				}
+
+				void
+				CaptureFile::close()
+				{
+					if (map == nullptr)
+						return;
+
+					munmap(const_cast<uint8_t *>(map), size);
+					map = nullptr;
+					size = 0;
+				}
+
+				uint32_t
+				CaptureFile::getFrequency() const
+				{
+					return header.frequency;
+				}
+
+				std::size_t
+				CaptureFile::getFirstOffset() const
+				{
+					return sizeof(header);
+				}
+
+				bool
+				CaptureFile::read(std::size_t &offset, diagnostics::CaptureRecord &record, const uint8_t *&data) const
+				{
+					if (map == nullptr || offset > size || size - offset < sizeof(record))
+						return false;
+
+					// Records are not aligned, as data lengths vary.
+					std::memcpy(&record, &map[offset], sizeof(record));
+
+					if (size - offset - sizeof(record) < record.length)
+						return false;
+
+					data = &map[offset + sizeof(record)];
+					offset += sizeof(record) + record.length;
+
+					return true;
+				}
+			}
+		}
+	}
+}
+
+#endif  // __linux__
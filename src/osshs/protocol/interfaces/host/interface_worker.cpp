@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/interfaces/host/interface_worker.hpp>
+
+#if OSSHS_PROTOCOL_THREADED
+
+#include <osshs/protocol/interfaces/interface.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				constexpr std::chrono::milliseconds InterfaceWorker::POLL_INTERVAL;
+
+				InterfaceWorker::InterfaceWorker(Interface &interface)
+					: interface(interface)
+				{
+				}
+
+				InterfaceWorker::~InterfaceWorker()
+				{
+					stop();
+				}
+
+				void
+				InterfaceWorker::start()
+				{
+					if (running.exchange(true))
+						return;
+
+					thread = std::thread(&InterfaceWorker::loop, this);
+				}
+
+				void
+				InterfaceWorker::stop()
+				{
+					if (!running.exchange(false))
+						return;
+
+					wake();
+					thread.join();
+
+					PacketRef eventPacket;
+					while (inbox.pop(eventPacket));
+				}
+
+				Backpressure
+				InterfaceWorker::post(PacketRef eventPacket)
+				{
+					if (!inbox.push(std::move(eventPacket)))
+					{
+						inboxDrops.fetch_add(1, std::memory_order_relaxed);
+						return Backpressure::OVERLOADED;
+					}
+
+					wake();
+
+					if (inbox.size() >= inbox.capacity() * 3 / 4)
+						return worst(Backpressure::CONGESTED, backpressure.load(std::memory_order_relaxed));
+
+					return backpressure.load(std::memory_order_relaxed);
+				}
+
+				void
+				InterfaceWorker::wake()
+				{
+					// Only the first signal after the worker went to sleep has to take the lock.
+					if (signalled.exchange(true))
+						return;
+
+					std::lock_guard<std::mutex> lock(wakeMutex);
+					wakeCondition.notify_one();
+				}
+
+				void
+				InterfaceWorker::loop()
+				{
+					while (running.load())
+					{
+						{
+							std::unique_lock<std::mutex> lock(wakeMutex);
+							wakeCondition.wait_for(lock, POLL_INTERVAL, [this]() {
+								return signalled.load() || !running.load();
+							});
+						}
+
+						signalled.store(false);
+
+						drainInbox();
+
+						while (running.load() && interface.isReady())
+						{
+							interface.run();
+							drainInbox();
+						}
+					}
+				}
+
+				void
+				InterfaceWorker::drainInbox()
+				{
+					PacketRef eventPacket;
+					Backpressure worstBackpressure = Backpressure::NONE;
+					bool drained = false;
+
+					while (inbox.pop(eventPacket))
+					{
+						worstBackpressure = worst(worstBackpressure, interface.enqueueEventPacket(std::move(eventPacket)));
+						drained = true;
+					}
+
+					interface.statistics.queueDrops += inboxDrops.exchange(0, std::memory_order_relaxed);
+
+					if (drained)
+						backpressure.store(worstBackpressure, std::memory_order_relaxed);
+				}
+			}
+		}
+	}
+}
+
+#endif  // OSSHS_PROTOCOL_THREADED
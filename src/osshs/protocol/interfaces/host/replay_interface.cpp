@@ -0,0 +1,210 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/interfaces/host/replay_interface.hpp>
+
+#if defined(__linux__)
+
+#include <osshs/log/logger.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				ReplayInterface::ReplayInterface(const CaptureFile &captureFile)
+					: captureFile(captureFile), offset(captureFile.getFirstOffset())
+				{
+				}
+
+				void
+				ReplayInterface::setSpeed(double speed)
+				{
+					this->speed = speed;
+				}
+
+				void
+				ReplayInterface::rewind()
+				{
+					offset = captureFile.getFirstOffset();
+					started = false;
+				}
+
+				bool
+				ReplayInterface::isFinished() const
+				{
+					std::size_t next = offset;
+					diagnostics::CaptureRecord record;
+					const uint8_t *data;
+
+					return !captureFile.read(next, record, data);
+				}
+
+				const ReplayStatistics &
+				ReplayInterface::getReplayStatistics() const
+				{
+					return replayStatistics;
+				}
+
+				bool
+				ReplayInterface::run()
+				{
+					VirtualInterface::run();
+
+					for (uint16_t i = 0; i < BURST; i++)
+					{
+						std::size_t next = offset;
+						diagnostics::CaptureRecord record;
+						const uint8_t *data;
+
+						if (!captureFile.read(next, record, data))
+							break;
+
+						if (!started)
+						{
+							started = true;
+							firstTimestamp = record.timestamp;
+							startTime = std::chrono::steady_clock::now();
+						}
+
+						if (!isDue(record))
+							break;
+
+						offset = next;
+						replay(record, data);
+					}
+
+					return true;
+				}
+
+				bool
+				ReplayInterface::isReady() const
+				{
+					if (VirtualInterface::isReady())
+						return true;
+
+					std::size_t next = offset;
+					diagnostics::CaptureRecord record;
+					const uint8_t *data;
+
+					return captureFile.read(next, record, data) && (!started || isDue(record));
+				}
+
+				bool
+				ReplayInterface::isDue(const diagnostics::CaptureRecord &record) const
+				{
+					if (speed <= 0)
+						return true;
+
+					double capturedSeconds = static_cast<double>(record.timestamp - firstTimestamp) / captureFile.getFrequency();
+					std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+					return elapsed.count() * speed >= capturedSeconds;
+				}
+
+				void
+				ReplayInterface::replay(const diagnostics::CaptureRecord &record, const uint8_t *data)
+				{
+					replayStatistics.records++;
+
+					switch (record.type)
+					{
+						case diagnostics::CaptureRecordType::CAN_FRAME:
+						{
+							replayStatistics.canFrames++;
+							statistics.framesIn++;
+
+							if (record.length > can::ClassicCanHeader::MTU)
+							{
+								replayStatistics.malformed++;
+								return;
+							}
+
+							// Transmitters on different channels may share a mac, so packets are told apart by both.
+							uint8_t channel = record.flags & diagnostics::CaptureRecord::CHANNEL_MASK;
+							uint32_t key = (static_cast<uint32_t>(channel) << 16) |
+								can::CanIdentifier::TransmitterMac::get(record.identifier);
+
+							switch (reassembler.push(key, record.identifier, data, record.length))
+							{
+								case ReassemblyResult::INCOMPLETE:
+									return;
+								case ReassemblyResult::COMPLETE:
+									break;
+								case ReassemblyResult::NO_MEMORY:
+									OSSHS_LOG_ERROR("Failed to allocate memory for a buffer.");
+									statistics.allocationFailures++;
+									return;
+								default:
+									replayStatistics.malformed++;
+									return;
+							}
+
+							PacketBuffer &buffer = reassembler.getCompleted();
+							inject(buffer.get(), buffer.getLength());
+							buffer.release();
+
+							return;
+						}
+						case diagnostics::CaptureRecordType::EVENT_PACKET:
+							inject(data, record.length);
+							return;
+						default:
+							replayStatistics.malformed++;
+							return;
+					}
+				}
+
+				void
+				ReplayInterface::inject(const uint8_t *data, uint16_t length)
+				{
+					PacketRef eventPacket = EventPacket::make(data, length, getEventCallback());
+
+					if (eventPacket == nullptr)
+					{
+						OSSHS_LOG_ERROR("Failed to allocate memory for an event packet.");
+						statistics.allocationFailures++;
+						return;
+					}
+
+					if (eventPacket->isMalformed())
+					{
+						replayStatistics.malformed++;
+						return;
+					}
+
+					replayStatistics.eventPackets++;
+					replayStatistics.bytes += length;
+
+					receive(std::move(eventPacket), length);
+				}
+			}
+		}
+	}
+}
+
+#endif  // __linux__
@@ -0,0 +1,259 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/interfaces/host/serial_port.hpp>
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <osshs/log/logger.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				static speed_t
+				getSpeed(uint32_t baudRate)
+				{
+					switch (baudRate)
+					{
+						case 9600:
+							return B9600;
+						case 19200:
+							return B19200;
+						case 38400:
+							return B38400;
+						case 57600:
+							return B57600;
+						case 115200:
+							return B115200;
+						case 230400:
+							return B230400;
+						case 460800:
+							return B460800;
+						case 921600:
+							return B921600;
+						default:
+							return B0;
+					}
+				}
+
+				SerialPort::~SerialPort()
+				{
+					close();
+				}
+
+				bool
+				SerialPort::open(const char *path, uint32_t baudRate)
+				{
+					speed_t speed = getSpeed(baudRate);
+
+					if (speed == B0)
+					{
+						OSSHS_LOG_ERROR("Unsupported baud rate(baudRate = %u).", baudRate);
+						return false;
+					}
+
+					int deviceDescriptor = ::open(path, O_RDWR | O_NOCTTY);
+
+					if (deviceDescriptor < 0)
+					{
+						OSSHS_LOG_ERROR("Failed to open %s(errno = %d).", path, errno);
+						return false;
+					}
+
+					struct termios options;
+
+					if (::tcgetattr(deviceDescriptor, &options) < 0)
+					{
+						OSSHS_LOG_ERROR("Failed to get attributes of %s(errno = %d).", path, errno);
+						::close(deviceDescriptor);
+						return false;
+					}
+
+					::cfmakeraw(&options);
+					::cfsetispeed(&options, speed);
+					::cfsetospeed(&options, speed);
+					options.c_cflag |= CLOCAL | CREAD;
+
+					if (::tcsetattr(deviceDescriptor, TCSANOW, &options) < 0)
+					{
+						OSSHS_LOG_ERROR("Failed to configure %s(errno = %d).", path, errno);
+						::close(deviceDescriptor);
+						return false;
+					}
+
+					return open(deviceDescriptor);
+				}
+
+				bool
+				SerialPort::open(int fileDescriptor)
+				{
+					close();
+
+					int flags = ::fcntl(fileDescriptor, F_GETFL, 0);
+
+					if (flags < 0 || ::fcntl(fileDescriptor, F_SETFL, flags | O_NONBLOCK) < 0)
+					{
+						OSSHS_LOG_ERROR("Failed to make serial port non-blocking(errno = %d).", errno);
+						::close(fileDescriptor);
+						return false;
+					}
+
+					this->fileDescriptor = fileDescriptor;
+					return true;
+				}
+
+				void
+				SerialPort::close()
+				{
+					if (fileDescriptor < 0)
+						return;
+
+					::close(fileDescriptor);
+					fileDescriptor = -1;
+					rxCount = 0;
+					rxIndex = 0;
+					txCount = 0;
+				}
+
+				int
+				SerialPort::getFileDescriptor() const
+				{
+					return fileDescriptor;
+				}
+
+				std::size_t
+				SerialPort::write(const uint8_t *data, std::size_t length)
+				{
+					if (fileDescriptor < 0)
+						return 0;
+
+					if (txCount == BUFFER_SIZE)
+						flush();
+
+					std::size_t copyLength = std::min(length, BUFFER_SIZE - txCount);
+
+					std::copy(&data[0], &data[copyLength], &txBuffer[txCount]);
+					txCount += copyLength;
+
+					return copyLength;
+				}
+
+				bool
+				SerialPort::flush()
+				{
+					if (txCount == 0)
+						return true;
+
+					ssize_t written = ::write(fileDescriptor, txBuffer, txCount);
+
+					if (written < 0)
+					{
+						if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+						{
+							OSSHS_LOG_WARNING("Dropping %u bytes written to serial port(errno = %d).",
+								static_cast<unsigned int>(txCount), errno);
+							txCount = 0;
+						}
+
+						return txCount == 0;
+					}
+
+					// Bytes the kernel did not take are kept in order for the next flush.
+					std::copy(&txBuffer[written], &txBuffer[txCount], &txBuffer[0]);
+					txCount -= written;
+
+					return txCount == 0;
+				}
+
+				bool
+				SerialPort::hasPendingTransmissions() const
+				{
+					return txCount > 0;
+				}
+
+				bool
+				SerialPort::read(uint8_t &data)
+				{
+					return read(&data, 1) == 1;
+				}
+
+				std::size_t
+				SerialPort::read(uint8_t *data, std::size_t length)
+				{
+					if (rxIndex == rxCount && !receive())
+						return 0;
+
+					std::size_t copyLength = std::min(length, rxCount - rxIndex);
+
+					std::copy(&rxBuffer[rxIndex], &rxBuffer[rxIndex + copyLength], &data[0]);
+					rxIndex += copyLength;
+
+					return copyLength;
+				}
+
+				std::size_t
+				SerialPort::getReceivedLength() const
+				{
+					return rxCount - rxIndex;
+				}
+
+				bool
+				SerialPort::receive()
+				{
+					if (fileDescriptor < 0)
+						return false;
+
+					rxIndex = 0;
+					rxCount = 0;
+
+					ssize_t received = ::read(fileDescriptor, rxBuffer, BUFFER_SIZE);
+
+					if (received < 0)
+					{
+						if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+							OSSHS_LOG_WARNING("Failed to read from serial port(errno = %d).", errno);
+
+						return false;
+					}
+
+					rxCount = received;
+
+					return rxCount > 0;
+				}
+			}
+		}
+	}
+}
+
+#endif  // __linux__
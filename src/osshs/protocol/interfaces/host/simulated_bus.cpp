@@ -0,0 +1,209 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/interfaces/host/simulated_bus.hpp>
+#include <osshs/protocol/interfaces/can/bus_load_estimator.hpp>
+#include <osshs/log/logger.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				SimulatedBus::SimulatedBus(uint32_t bitRate)
+					: bitRate(bitRate)
+				{
+				}
+
+				uint64_t
+				SimulatedBus::getTime() const
+				{
+					return time;
+				}
+
+				uint64_t
+				SimulatedBus::getBusyTime() const
+				{
+					return busyTime;
+				}
+
+				uint64_t
+				SimulatedBus::getFrameCount() const
+				{
+					return frameCount;
+				}
+
+				bool
+				SimulatedBus::step(uint64_t until)
+				{
+					SimulatedBusInterface *winner = nullptr;
+
+					for (SimulatedBusInterface *interface : interfaces)
+					{
+						if (interface->framePending && (winner == nullptr || interface->frameIdentifier < winner->frameIdentifier))
+							winner = interface;
+					}
+
+					if (winner == nullptr)
+					{
+						if (until > time)
+							time = until;
+
+						return false;
+					}
+
+					uint64_t duration = static_cast<uint64_t>(can::BusLoadEstimator::getFrameBits(winner->frameLength)) *
+						1000000000 / bitRate;
+
+					time += duration;
+					busyTime += duration;
+					frameCount++;
+
+					winner->completeFrame();
+
+					return true;
+				}
+
+				SimulatedBusInterface::SimulatedBusInterface(SimulatedBus &bus, uint32_t mac)
+					: bus(bus)
+				{
+					setMac(mac);
+					bus.interfaces.push_back(this);
+				}
+
+				bool
+				SimulatedBusInterface::run()
+				{
+					if (currentEventPacket != nullptr || !isTransmitPending())
+						return true;
+
+					currentEventPacket = std::move(eventPacketQueue.front());
+					eventPacketQueue.pop();
+
+					if (!serializeEventPacket(currentEventPacket, buffer))
+					{
+						OSSHS_LOG_WARNING("Failed to serialize event packet.");
+						currentEventPacket.reset();
+						return true;
+					}
+
+					fragmenter.start(buffer.get(), buffer.getLength(), can::CanIdentifier::TransmitterMac::set(0, mac));
+					loadFrame();
+
+					return true;
+				}
+
+				bool
+				SimulatedBusInterface::isReady() const
+				{
+					return currentEventPacket == nullptr && VirtualInterface::isReady();
+				}
+
+				bool
+				SimulatedBusInterface::loadFrame()
+				{
+					framePending = fragmenter.hasNext();
+
+					if (framePending)
+						frameLength = fragmenter.next(frameIdentifier, frameData);
+
+					return framePending;
+				}
+
+				void
+				SimulatedBusInterface::completeFrame()
+				{
+					statistics.framesOut++;
+
+					for (SimulatedBusInterface *interface : bus.interfaces)
+					{
+						if (interface != this)
+							interface->deliver(frameIdentifier, frameData, frameLength);
+					}
+
+					if (loadFrame())
+						return;
+
+					statistics.packetsOut++;
+					statistics.bytesOut += buffer.getLength();
+
+					buffer.release();
+					currentEventPacket.reset();
+
+					signalReady();
+				}
+
+				void
+				SimulatedBusInterface::deliver(uint32_t identifier, const uint8_t *data, uint8_t length)
+				{
+					statistics.framesIn++;
+
+					// Frames are never lost on the simulated bus, so packets are not expired, which would take wall time.
+					switch (reassembler.push(can::CanIdentifier::TransmitterMac::get(identifier), identifier, data, length))
+					{
+						case ReassemblyResult::INCOMPLETE:
+							return;
+						case ReassemblyResult::MALFORMED:
+						case ReassemblyResult::ORPHANED:
+							OSSHS_LOG_WARNING("Discarding malformed CAN frame.");
+							statistics.malformedDrops++;
+							return;
+						case ReassemblyResult::NO_MEMORY:
+							OSSHS_LOG_ERROR("Failed to allocate memory for a buffer.");
+							statistics.allocationFailures++;
+							return;
+						case ReassemblyResult::COMPLETE:
+							break;
+					}
+
+					PacketBuffer &completed = reassembler.getCompleted();
+
+					uint16_t packetLength = completed.getLength();
+
+					PacketRef eventPacket = EventPacket::make(completed.get(), packetLength, getEventCallback());
+
+					completed.release();
+
+					if (eventPacket == nullptr)
+					{
+						OSSHS_LOG_ERROR("Failed to allocate memory for an event packet.");
+						statistics.allocationFailures++;
+						return;
+					}
+
+					if (eventPacket->isMalformed())
+					{
+						statistics.malformedDrops++;
+						return;
+					}
+
+					receive(std::move(eventPacket), packetLength);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,252 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/interfaces/host/socket_can.hpp>
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <net/if.h>
+#include <unistd.h>
+#include <osshs/log/logger.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				SocketCanPort::~SocketCanPort()
+				{
+					close();
+				}
+
+				bool
+				SocketCanPort::open(const char *interfaceName)
+				{
+					int socketDescriptor = ::socket(PF_CAN, SOCK_RAW, CAN_RAW);
+
+					if (socketDescriptor < 0)
+					{
+						OSSHS_LOG_ERROR("Failed to open CAN socket(errno = %d).", errno);
+						return false;
+					}
+
+					struct sockaddr_can address;
+					std::memset(&address, 0, sizeof(address));
+					address.can_family = AF_CAN;
+					address.can_ifindex = if_nametoindex(interfaceName);
+
+					if (address.can_ifindex == 0 ||
+						::bind(socketDescriptor, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) < 0)
+					{
+						OSSHS_LOG_ERROR("Failed to bind CAN socket to %s(errno = %d).", interfaceName, errno);
+						::close(socketDescriptor);
+						return false;
+					}
+
+					return open(socketDescriptor);
+				}
+
+				bool
+				SocketCanPort::open(int fileDescriptor)
+				{
+					close();
+
+					int flags = ::fcntl(fileDescriptor, F_GETFL, 0);
+
+					if (flags < 0 || ::fcntl(fileDescriptor, F_SETFL, flags | O_NONBLOCK) < 0)
+					{
+						OSSHS_LOG_ERROR("Failed to make CAN socket non-blocking(errno = %d).", errno);
+						::close(fileDescriptor);
+						return false;
+					}
+
+					this->fileDescriptor = fileDescriptor;
+					initializeHeaders();
+
+					return true;
+				}
+
+				void
+				SocketCanPort::close()
+				{
+					if (fileDescriptor < 0)
+						return;
+
+					::close(fileDescriptor);
+					fileDescriptor = -1;
+					rxCount = 0;
+					rxIndex = 0;
+					txCount = 0;
+				}
+
+				int
+				SocketCanPort::getFileDescriptor() const
+				{
+					return fileDescriptor;
+				}
+
+				bool
+				SocketCanPort::isMessageAvailable()
+				{
+					return rxIndex < rxCount || receive();
+				}
+
+				bool
+				SocketCanPort::getMessage(modm::can::Message &message)
+				{
+					if (!isMessageAvailable())
+						return false;
+
+					const struct can_frame &frame = rxFrames[rxIndex++];
+
+					message.setIdentifier(frame.can_id & CAN_EFF_MASK);
+					message.setExtended(frame.can_id & CAN_EFF_FLAG);
+					message.setLength(std::min<uint8_t>(frame.can_dlc, CAN_MAX_DLEN));
+					std::copy(&frame.data[0], &frame.data[message.getLength()], &message.data[0]);
+
+					return true;
+				}
+
+				bool
+				SocketCanPort::isReadyToSend()
+				{
+					if (txCount == BATCH_SIZE)
+						flush();
+
+					return txCount < BATCH_SIZE;
+				}
+
+				bool
+				SocketCanPort::sendMessage(const modm::can::Message &message)
+				{
+					if (fileDescriptor < 0 || txCount == BATCH_SIZE)
+						return false;
+
+					struct can_frame &frame = txFrames[txCount++];
+
+					frame.can_id = message.isExtended() ? (message.getIdentifier() | CAN_EFF_FLAG) : message.getIdentifier();
+					frame.can_dlc = std::min<uint8_t>(message.getLength(), CAN_MAX_DLEN);
+					std::copy(&message.data[0], &message.data[frame.can_dlc], &frame.data[0]);
+
+					return true;
+				}
+
+				bool
+				SocketCanPort::flush()
+				{
+					if (txCount == 0)
+						return true;
+
+					int sent = ::sendmmsg(fileDescriptor, txHeaders, txCount, MSG_DONTWAIT);
+
+					if (sent < 0)
+					{
+						if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS)
+						{
+							OSSHS_LOG_WARNING("Dropping %u CAN frames(errno = %d).", txCount, errno);
+							txCount = 0;
+						}
+
+						return txCount == 0;
+					}
+
+					// Frames the kernel did not take are kept in order for the next flush.
+					std::copy(&txFrames[sent], &txFrames[txCount], &txFrames[0]);
+					txCount -= sent;
+
+					return txCount == 0;
+				}
+
+				bool
+				SocketCanPort::hasPendingTransmissions() const
+				{
+					return txCount > 0;
+				}
+
+				void
+				SocketCanPort::initializeHeaders()
+				{
+					std::memset(rxHeaders, 0, sizeof(rxHeaders));
+					std::memset(txHeaders, 0, sizeof(txHeaders));
+
+					for (uint8_t i = 0; i < BATCH_SIZE; i++)
+					{
+						rxVectors[i] = {&rxFrames[i], sizeof(struct can_frame)};
+						rxHeaders[i].msg_hdr.msg_iov = &rxVectors[i];
+						rxHeaders[i].msg_hdr.msg_iovlen = 1;
+
+						txVectors[i] = {&txFrames[i], sizeof(struct can_frame)};
+						txHeaders[i].msg_hdr.msg_iov = &txVectors[i];
+						txHeaders[i].msg_hdr.msg_iovlen = 1;
+					}
+				}
+
+				bool
+				SocketCanPort::receive()
+				{
+					if (fileDescriptor < 0)
+						return false;
+
+					rxIndex = 0;
+					rxCount = 0;
+
+					int received = ::recvmmsg(fileDescriptor, rxHeaders, BATCH_SIZE, MSG_DONTWAIT, nullptr);
+
+					if (received < 0)
+					{
+						if (errno != EAGAIN && errno != EWOULDBLOCK)
+							OSSHS_LOG_WARNING("Failed to receive CAN frames(errno = %d).", errno);
+
+						return false;
+					}
+
+					// Error frames and truncated datagrams are dropped while compacting the batch.
+					for (int i = 0; i < received; i++)
+					{
+						const struct can_frame &frame = rxFrames[i];
+
+						if (rxHeaders[i].msg_len != sizeof(struct can_frame) || (frame.can_id & (CAN_ERR_FLAG | CAN_RTR_FLAG)))
+							continue;
+
+						if (rxCount != i)
+							rxFrames[rxCount] = frame;
+
+						rxCount++;
+					}
+
+					return rxCount > 0;
+				}
+			}
+		}
+	}
+}
+
+#endif  // __linux__
@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/interfaces/host/virtual_interface.hpp>
+#include <osshs/log/logger.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			namespace host
+			{
+				uint64_t
+				VirtualInterface::getTransmittedCount() const
+				{
+					return transmittedCount.load(std::memory_order_relaxed);
+				}
+
+				bool
+				VirtualInterface::run()
+				{
+					while (isTransmitPending())
+					{
+						PacketRef eventPacket = std::move(eventPacketQueue.front());
+						eventPacketQueue.pop();
+
+						transmit(eventPacket);
+
+						statistics.packetsOut++;
+						transmittedCount.fetch_add(1, std::memory_order_relaxed);
+					}
+
+					return true;
+				}
+
+				void
+				VirtualInterface::receive(PacketRef eventPacket, uint16_t packetLength)
+				{
+					statistics.packetsIn++;
+					statistics.bytesIn += packetLength;
+
+					routeEventPacket(std::move(eventPacket), packetLength);
+				}
+
+				void
+				VirtualInterface::transmit(const PacketRef &)
+				{
+				}
+
+				void
+				VirtualInterface::initialize()
+				{
+					OSSHS_LOG_INFO("Initializing virtual interface.");
+				}
+			}
+		}
+	}
+}
@@ -24,6 +24,8 @@
 
 #include <osshs/protocol/interfaces/interface.hpp>
 #include <osshs/log/logger.hpp>
+#include <osshs/protocol/interfaces/host/interface_worker.hpp>
+#include <osshs/protocol/diagnostics/trace.hpp>
 
 namespace osshs
 {
@@ -31,19 +33,287 @@ namespace osshs
 	{
 		namespace interfaces
 		{
+			const InterfaceStatistics &
+			Interface::getStatistics() const
+			{
+				return statistics;
+			}
+
+			void
+			Interface::resetStatistics()
+			{
+				statistics = InterfaceStatistics();
+			}
+
+			EventSubscription &
+			Interface::getSubscription()
+			{
+				return subscription;
+			}
+
+			bool
+			Interface::configureQueue(std::size_t capacity, DropPolicy dropPolicy, bool coalescing)
+			{
+				return eventPacketQueue.configure(capacity, dropPolicy, coalescing);
+			}
+
+			void
+			Interface::setEgressRate(uint32_t bytesPerSecond, uint32_t burstBytes)
+			{
+				egressShaper.configure(bytesPerSecond, burstBytes);
+			}
+
+			void
+			Interface::setIngressRatePerSource(uint32_t bytesPerSecond, uint32_t burstBytes)
+			{
+				ingressLimiter.configure(bytesPerSecond, burstBytes);
+			}
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+			const diagnostics::LatencyProfile &
+			Interface::getLatencyProfile() const
+			{
+				return latencyProfile;
+			}
+#endif
+
+			void
+			Interface::signalReady()
+			{
+#if OSSHS_PROTOCOL_THREADED
+				if (worker != nullptr)
+				{
+					worker->wake();
+					return;
+				}
+#endif
+
+				if (readyMask != nullptr && interfaceIndex != NO_INDEX)
+				{
+					readyMask->fetch_or(0b1 << interfaceIndex);
+				}
+			}
+
+			void
+			Interface::setCaptureCallback(diagnostics::CaptureCallback callback)
+			{
+#if !OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION && !OSSHS_PROTOCOL_TRACE
+				// Managers only enable the cycle counter for latency instrumentation and tracing.
+				diagnostics::CycleCounter::initialize();
+#endif
+
+				captureCallback = callback;
+			}
+
+			void
+			Interface::setMac(uint32_t mac)
+			{
+				this->mac = mac;
+			}
+
+			bool
+			Interface::isCongested()
+			{
+				return false;
+			}
+
+			bool
+			Interface::isReady() const
+			{
+				return !eventPacketQueue.empty() && !isEgressBlocked();
+			}
+
+			bool
+			Interface::isTransmitPending()
+			{
+				bool blocked = isEgressBlocked();
+
+				if (blocked && !egressThrottling)
+					statistics.egressThrottled++;
+
+				egressThrottling = blocked;
+
+				return !eventPacketQueue.empty() && !blocked;
+			}
+
+			bool
+			Interface::isEgressBlocked() const
+			{
+				return !eventPacketQueue.empty() &&
+					!eventPacketQueue.front()->isCommand() &&
+					!egressShaper.isConforming();
+			}
+
+			Backpressure
+			Interface::reportEventPacket(PacketRef eventPacket)
+			{
+#if OSSHS_PROTOCOL_THREADED
+				if (worker != nullptr)
+					return worker->post(std::move(eventPacket));
+#endif
+
+				return enqueueEventPacket(std::move(eventPacket));
+			}
+
+			Backpressure
+			Interface::enqueueEventPacket(PacketRef eventPacket)
+			{
+				if (eventPacket->isMultiTarget() && !subscription.contains(eventPacket->getEventType()))
+				{
+					statistics.unsubscribedDrops++;
+					return Backpressure::NONE;
+				}
+
+				OSSHS_PROTOCOL_TRACE_EVENT_PACKET(EVENT_PACKET_ENQUEUED, eventPacket, 0);
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+				if (!eventPacket->getLatencyTimestamps().has(diagnostics::LatencyStage::TX_ENQUEUED))
+				{
+					OSSHS_PROTOCOL_LATENCY_MARK(eventPacket, TX_ENQUEUED);
+				}
+#endif
+
+				Backpressure backpressure = Backpressure::NONE;
+
+				switch (eventPacketQueue.push(std::move(eventPacket)))
+				{
+					case QueueResult::QUEUED:
+						break;
+					case QueueResult::COALESCED:
+						statistics.queueCoalesced++;
+						backpressure = Backpressure::CONGESTED;
+						break;
+					case QueueResult::DROPPED_OLDEST:
+						statistics.queueDrops++;
+						backpressure = Backpressure::CONGESTED;
+						break;
+					case QueueResult::REJECTED:
+						statistics.queueDrops++;
+						return Backpressure::OVERLOADED;
+				}
+
+				statistics.updateQueueHighWaterMark(eventPacketQueue.size());
+
+				signalReady();
+
+				if (eventPacketQueue.isCongested() || isCongested())
+					backpressure = Backpressure::CONGESTED;
+
+				return backpressure;
+			}
+
+			bool
+			Interface::serializeEventPacket(const PacketRef &eventPacket, PacketBuffer &buffer)
+			{
+#if OSSHS_PROTOCOL_CONTAINER_EVENTS > 1
+				if (isFrontMergeableWith(*eventPacket))
+				{
+					std::unique_ptr<const uint8_t[]> events[OSSHS_PROTOCOL_CONTAINER_EVENTS];
+					events[0] = eventPacket->getEvent()->serialize();
+
+					if (events[0] == nullptr)
+					{
+						OSSHS_LOG_WARNING("Failed to serialize event.");
+						return false;
+					}
+
+					uint16_t packetLength = PacketHeader::getHeaderLength(eventPacket->isMultiTarget()) +
+						PacketHeader::EventLength::read(events[0].get());
+					uint8_t eventCount = 1;
+
+					// Merge the run of event packets at the head of the queue only and stop at the first event that does not fit.
+					// Anything behind another event packet could otherwise overtake an earlier event to the same receiver.
+					while (eventCount < OSSHS_PROTOCOL_CONTAINER_EVENTS && isFrontMergeableWith(*eventPacket) &&
+						packetLength + PacketHeader::MIN_EVENT_LENGTH <= OSSHS_PROTOCOL_CONTAINER_LENGTH)
+					{
+						std::unique_ptr<const uint8_t[]> serializedEvent = eventPacketQueue.front()->getEvent()->serialize();
+
+						if (serializedEvent == nullptr)
+							break;
+
+						uint16_t eventLength = PacketHeader::EventLength::read(serializedEvent.get());
+
+						if (packetLength + eventLength > OSSHS_PROTOCOL_CONTAINER_LENGTH)
+							break;
+
+						PacketRef mergedEventPacket = std::move(eventPacketQueue.front());
+						eventPacketQueue.pop();
+						OSSHS_PROTOCOL_TRACE_EVENT_PACKET(EVENT_PACKET_MERGED, mergedEventPacket, eventLength);
+
+						events[eventCount++] = std::move(serializedEvent);
+						packetLength += eventLength;
+					}
+
+					statistics.eventsMerged += eventCount - 1;
+
+					return buffer.serializeContainer(*eventPacket, events, eventCount);
+				}
+#endif
+
+				return buffer.serialize(*eventPacket);
+			}
+
+#if OSSHS_PROTOCOL_CONTAINER_EVENTS > 1
+			bool
+			Interface::isFrontMergeableWith(const EventPacket &eventPacket) const
+			{
+				return !eventPacketQueue.empty() && eventPacketQueue.front()->isMergeableWith(eventPacket);
+			}
+#endif
+
 			void
-			Interface::reportEventPacket(std::shared_ptr<EventPacket> eventPacket)
-			{
-				OSSHS_LOG_DEBUG(
-					"Handling event packet(multiTarget = %u, command = %u, transmitterMac = 0x%08x, receiverMac = 0x%08x, eventType = 0x%04x).",
-					eventPacket->isMultiTarget(),
-					eventPacket->isCommand(),
-					eventPacket->getTransmitterMac(),
-					eventPacket->getReceiverMac(),
-					eventPacket->getEvent()->getType()
-				);
-
-				eventPacketQueue.push(eventPacket);
+			Interface::routeEventPacket(PacketRef eventPacket, uint16_t packetLength)
+			{
+				if (!eventPacket->isCommand())
+				{
+					bool evicted;
+					bool conforming = ingressLimiter.tryConsume(eventPacket->getTransmitterMac(), packetLength, evicted);
+
+					if (evicted)
+						statistics.ingressEvictions++;
+
+					if (!conforming)
+					{
+						statistics.ingressThrottled++;
+						return;
+					}
+				}
+
+				if (eventPacketRouter == nullptr)
+				{
+					OSSHS_LOG_WARNING("Discarding event packet received by an unbound interface.");
+					return;
+				}
+
+				do
+				{
+					PacketRef nextEventPacket = eventPacket->takeNext();
+
+					if (nextEventPacket != nullptr)
+					{
+						statistics.eventsUnpacked++;
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+						nextEventPacket->getLatencyTimestamps() = eventPacket->getLatencyTimestamps();
+#endif
+					}
+
+					eventPacketRouter(routerContext, std::move(eventPacket), this);
+					eventPacket = std::move(nextEventPacket);
+				}
+				while (eventPacket != nullptr);
+			}
+
+			events::EventCallback
+			Interface::getEventCallback()
+			{
+				return [this](std::shared_ptr<events::Event> event)
+				{
+					if (eventRouter != nullptr)
+					{
+						eventRouter(routerContext, std::move(event));
+					}
+				};
 			}
 		}
 	}
@@ -25,6 +25,11 @@
 #include <osshs/protocol/interfaces/interface_manager.hpp>
 #include <osshs/system.hpp>
 #include <osshs/log/logger.hpp>
+#include <osshs/protocol/diagnostics/trace.hpp>
+
+#if OSSHS_PROTOCOL_IDLE_SLEEP
+	#include <modm/platform.hpp>
+#endif
 
 namespace osshs
 {
@@ -32,12 +37,35 @@ namespace osshs
 	{
 		namespace interfaces
 		{
-			std::vector<Interface*> InterfaceManager::interfaces;
+			InterfaceManager::InterfaceManager()
+				: readyMask(0), statisticsTimer(std::chrono::milliseconds(10000)), eventSink(&System::reportEvent)
+			{
+			}
+
+			InterfaceManager::~InterfaceManager()
+			{
+#if OSSHS_PROTOCOL_THREADED
+				stop();
+#endif
+
+				for (Interface *interface : interfaces)
+				{
+					interface->eventPacketRouter = nullptr;
+					interface->eventRouter = nullptr;
+					interface->routerContext = nullptr;
+					interface->readyMask = nullptr;
+					interface->interfaceIndex = Interface::NO_INDEX;
+				}
+			}
 
 			void
 			InterfaceManager::initialize()
 			{
 				OSSHS_LOG_INFO("Initializing interface manager.");
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION || OSSHS_PROTOCOL_TRACE
+				diagnostics::CycleCounter::initialize();
+#endif
 			}
 
 			void
@@ -45,73 +73,516 @@ namespace osshs
 			{
 				OSSHS_LOG_INFO("Registering interface.");
 
+#if OSSHS_PROTOCOL_STATIC_MEMORY
+				if (interfaces.size() == interfaces.capacity())
+				{
+					OSSHS_LOG_ERROR("Failed to register interface, OSSHS_PROTOCOL_MAX_INTERFACES reached.");
+					return;
+				}
+#endif
+
+				if (interfaces.size() < MAX_SIGNALLED_INTERFACES)
+				{
+					interface->interfaceIndex = interfaces.size();
+					interface->readyMask = &readyMask;
+				}
+				else
+				{
+					OSSHS_LOG_WARNING("Interface can not be signalled, it will only be stepped when ready.");
+				}
+
+				interface->eventPacketRouter = &InterfaceManager::routeEventPacket;
+				interface->eventRouter = &InterfaceManager::routeEvent;
+				interface->routerContext = this;
+
+				if (mac != 0x00000000)
+					interface->setMac(mac);
+
 				interfaces.push_back(interface);
 				interface->initialize();
+				interface->signalReady();
 			}
 
-			void
-			InterfaceManager::reportEventPacket(std::shared_ptr<EventPacket> eventPacket, Interface *sourceInterface)
+			Backpressure
+			InterfaceManager::reportEventPacket(PacketRef eventPacket, Interface *sourceInterface)
 			{
-				OSSHS_LOG_DEBUG(
-					"Handling event packet(multiTarget = %u, command = %u, transmitterMac = 0x%08x, receiverMac = 0x%08x, eventType = 0x%04x).",
-					eventPacket->isMultiTarget(),
-					eventPacket->isCommand(),
-					eventPacket->getTransmitterMac(),
-					eventPacket->getReceiverMac(),
-					eventPacket->getEvent()->getType()
-				);
-
 				if (eventPacket->isMalformed())
 				{
 					OSSHS_LOG_WARNING("Discarding malformed event packet.");
-					return;
+
+					if (sourceInterface != nullptr)
+						sourceInterface->statistics.malformedDrops++;
+
+					return Backpressure::NONE;
+				}
+
+				OSSHS_PROTOCOL_TRACE_EVENT_PACKET(EVENT_PACKET_DISPATCHED, eventPacket, 0);
+				OSSHS_PROTOCOL_LATENCY_MARK(eventPacket, DISPATCHED);
+
+				if (sourceInterface != nullptr)
+				{
+					OSSHS_PROTOCOL_LATENCY_RECORD_RECEIVE(sourceInterface, eventPacket);
 				}
 
+				Backpressure backpressure = Backpressure::NONE;
+
 				for (Interface *interface : interfaces)
 				{
 					if (interface == sourceInterface)
 						continue;
 						
-					interface->reportEventPacket(eventPacket);
+					backpressure = worst(backpressure, interface->reportEventPacket(eventPacket));
+				}
+
+#if OSSHS_PROTOCOL_THREADED
+				// Event packets arrive on every worker thread, while the sink expects events one at a time.
+				std::lock_guard<std::mutex> lock(sinkMutex);
+#endif
+
+				if (eventPacket->getRequestId() != PacketHeader::NO_REQUEST_ID)
+				{
+					if (!eventPacket->isCommand() && eventPacket->getReceiverMac() == mac)
+					{
+						completeRequest(*eventPacket);
+						return backpressure;
+					}
+
+					if (eventPacket->isCommand() && requestHandler != nullptr &&
+						(eventPacket->isMultiTarget() || eventPacket->getReceiverMac() == mac))
+					{
+						requestHandler(Request{eventPacket->getEvent(), eventPacket->getTransmitterMac(), eventPacket->getRequestId()});
+						return backpressure;
+					}
 				}
 
-				System::reportEvent(eventPacket->getEvent());
+				if (eventSink != nullptr)
+				{
+					eventSink(eventPacket->getEvent());
+				}
+
+				return backpressure;
 			}
 
-			void
+			Backpressure
 			InterfaceManager::reportEvent(std::shared_ptr<events::Event> event)
 			{
-				OSSHS_LOG_DEBUG("Handling event(type = 0x%04x).", event->getType());
+				OSSHS_PROTOCOL_TRACE_EVENT(EVENT_REPORTED, event);
 
-				std::shared_ptr<EventPacket> eventPacket(new (std::nothrow) EventPacket(
+				PacketRef eventPacket = EventPacket::make(
 					event,
-					0x00000000
-				));
+					mac
+				);
 
 				if (eventPacket == nullptr)
 				{
 					OSSHS_LOG_ERROR("Failed to allocate memory for an event packet.");
-					return;
+					return Backpressure::OVERLOADED;
 				}
 
 				if (eventPacket->isMalformed())
 				{
 					OSSHS_LOG_WARNING("Discarding malformed event packet.");
+					return Backpressure::NONE;
+				}
+
+				return transmit(eventPacket);
+			}
+
+			RequestHandle
+			InterfaceManager::sendRequest(std::shared_ptr<events::Event> command, uint32_t receiverMac, ResponseCallback callback,
+				std::chrono::milliseconds timeout, uint8_t retries)
+			{
+				if (command == nullptr)
+				{
+					OSSHS_LOG_WARNING("Discarding request without a command.");
+					return RequestHandle();
+				}
+
+				uint16_t requestId;
+
+				{
+#if OSSHS_PROTOCOL_THREADED
+					std::lock_guard<std::mutex> lock(requestMutex);
+#endif
+
+					requestId = pendingRequests.add(command, receiverMac, callback, timeout, retries);
+				}
+
+				if (requestId == PacketHeader::NO_REQUEST_ID)
+				{
+					OSSHS_LOG_WARNING("Failed to send request, OSSHS_PROTOCOL_PENDING_REQUESTS reached.");
+					return RequestHandle();
+				}
+
+				PacketRef eventPacket = EventPacket::make(command, mac, receiverMac, true, requestId);
+
+				if (eventPacket == nullptr)
+				{
+					OSSHS_LOG_ERROR("Failed to allocate memory for an event packet.");
+					cancelRequest(RequestHandle(requestId));
+					return RequestHandle();
+				}
+
+				if (eventPacket->isMalformed())
+				{
+					OSSHS_LOG_WARNING("Discarding malformed event packet.");
+					cancelRequest(RequestHandle(requestId));
+					return RequestHandle();
+				}
+
+				transmit(eventPacket);
+
+				return RequestHandle(requestId);
+			}
+
+			bool
+			InterfaceManager::cancelRequest(RequestHandle handle)
+			{
+#if OSSHS_PROTOCOL_THREADED
+				std::lock_guard<std::mutex> lock(requestMutex);
+#endif
+
+				RequestTable::Entry *entry = pendingRequests.find(handle.getRequestId());
+
+				if (entry == nullptr)
+					return false;
+
+				pendingRequests.release(*entry);
+				return true;
+			}
+
+			bool
+			InterfaceManager::isPending(RequestHandle handle)
+			{
+#if OSSHS_PROTOCOL_THREADED
+				std::lock_guard<std::mutex> lock(requestMutex);
+#endif
+
+				return pendingRequests.find(handle.getRequestId()) != nullptr;
+			}
+
+			Backpressure
+			InterfaceManager::respond(const Request &request, std::shared_ptr<events::Event> response)
+			{
+				PacketRef eventPacket = EventPacket::make(response, mac, request.transmitterMac, false, request.requestId);
+
+				if (eventPacket == nullptr)
+				{
+					OSSHS_LOG_ERROR("Failed to allocate memory for an event packet.");
+					return Backpressure::OVERLOADED;
+				}
+
+				if (eventPacket->isMalformed())
+				{
+					OSSHS_LOG_WARNING("Discarding malformed event packet.");
+					return Backpressure::NONE;
+				}
+
+				return transmit(eventPacket);
+			}
+
+			void
+			InterfaceManager::setRequestHandler(RequestHandler handler)
+			{
+				requestHandler = handler;
+			}
+
+			void
+			InterfaceManager::setMac(uint32_t mac)
+			{
+				this->mac = mac;
+
+				for (Interface *interface : interfaces)
+					interface->setMac(mac);
+			}
+
+			void
+			InterfaceManager::run()
+			{
+				expireRequests();
+
+#if OSSHS_PROTOCOL_THREADED
+				if (!workers.empty())
+				{
+					if (statisticsCallback != nullptr && statisticsTimer.execute())
+						publishStatistics();
+
 					return;
 				}
+#endif
+
+				uint32_t signalled = readyMask.exchange(0);
+				bool stepped = false;
 
 				for (Interface *interface : interfaces)
 				{
-					interface->reportEventPacket(eventPacket);
+					bool isSignalled = interface->interfaceIndex != Interface::NO_INDEX &&
+						((signalled >> interface->interfaceIndex) & 0b1);
+
+					if (isSignalled || interface->isReady())
+					{
+						interface->run();
+						stepped = true;
+					}
+				}
+
+				if (!stepped)
+				{
+					sleepUntilReady();
+				}
+
+				if (statisticsCallback != nullptr && statisticsTimer.execute())
+				{
+					publishStatistics();
 				}
 			}
 
+#if OSSHS_PROTOCOL_THREADED
 			void
-			InterfaceManager::run()
+			InterfaceManager::start()
+			{
+				if (!workers.empty())
+					return;
+
+				OSSHS_LOG_INFO("Starting %u interface worker threads.", static_cast<unsigned int>(interfaces.size()));
+
+				for (Interface *interface : interfaces)
+				{
+					workers.push_back(std::unique_ptr<host::InterfaceWorker>(new host::InterfaceWorker(*interface)));
+					interface->worker = workers.back().get();
+				}
+
+				// Workers only start once every interface has one, so fan-out never reaches an interface directly.
+				for (std::unique_ptr<host::InterfaceWorker> &worker : workers)
+				{
+					worker->start();
+				}
+			}
+
+			void
+			InterfaceManager::stop()
+			{
+				for (std::unique_ptr<host::InterfaceWorker> &worker : workers)
+				{
+					worker->stop();
+				}
+
+				for (Interface *interface : interfaces)
+				{
+					interface->worker = nullptr;
+				}
+
+				workers.clear();
+			}
+#endif
+
+			bool
+			InterfaceManager::isIdle()
+			{
+				if (readyMask.load() != 0)
+					return false;
+
+				for (Interface *interface : interfaces)
+				{
+					if (interface->isReady())
+						return false;
+				}
+
+				return true;
+			}
+
+			void
+			InterfaceManager::signalReady(Interface *interface)
+			{
+				if (interface->interfaceIndex == Interface::NO_INDEX)
+					return;
+
+				readyMask.fetch_or(0b1 << interface->interfaceIndex);
+			}
+
+			void
+			InterfaceManager::sleepUntilReady()
+			{
+#if OSSHS_PROTOCOL_IDLE_SLEEP
+				// Interrupts are masked so that a signal arriving between the check and WFI still wakes the core.
+				__disable_irq();
+
+				if (readyMask.load() == 0)
+					__WFI();
+
+				__enable_irq();
+#endif
+			}
+
+			std::size_t
+			InterfaceManager::getInterfaceCount()
+			{
+				return interfaces.size();
+			}
+
+			bool
+			InterfaceManager::getStatistics(std::size_t interfaceIndex, InterfaceStatistics &statistics)
+			{
+				if (interfaceIndex >= interfaces.size())
+					return false;
+
+				statistics = interfaces[interfaceIndex]->getStatistics();
+				return true;
+			}
+
+			void
+			InterfaceManager::resetStatistics()
+			{
+				for (Interface *interface : interfaces)
+				{
+					interface->resetStatistics();
+				}
+			}
+
+			void
+			InterfaceManager::setStatisticsCallback(StatisticsCallback callback, std::chrono::milliseconds period)
+			{
+				statisticsCallback = callback;
+				statisticsTimer.restart(period);
+			}
+
+			void
+			InterfaceManager::setEventSink(EventSink sink)
+			{
+				eventSink = sink;
+			}
+
+#if OSSHS_PROTOCOL_LATENCY_INSTRUMENTATION
+			bool
+			InterfaceManager::getLatencyProfile(std::size_t interfaceIndex, diagnostics::LatencyProfile &latencyProfile)
+			{
+				if (interfaceIndex >= interfaces.size())
+					return false;
+
+				latencyProfile = interfaces[interfaceIndex]->getLatencyProfile();
+				return true;
+			}
+#endif
+
+			void
+			InterfaceManager::routeEventPacket(void *context, PacketRef eventPacket, Interface *sourceInterface)
 			{
+				static_cast<InterfaceManager *>(context)->reportEventPacket(std::move(eventPacket), sourceInterface);
+			}
+
+			Backpressure
+			InterfaceManager::routeEvent(void *context, std::shared_ptr<events::Event> event)
+			{
+				return static_cast<InterfaceManager *>(context)->reportEvent(std::move(event));
+			}
+
+			Backpressure
+			InterfaceManager::transmit(const PacketRef &eventPacket)
+			{
+				Backpressure backpressure = Backpressure::NONE;
+
 				for (Interface *interface : interfaces)
 				{
-					interface->run();
+					backpressure = worst(backpressure, interface->reportEventPacket(eventPacket));
+				}
+
+				return backpressure;
+			}
+
+			void
+			InterfaceManager::completeRequest(const EventPacket &response)
+			{
+				ResponseCallback callback;
+
+				{
+#if OSSHS_PROTOCOL_THREADED
+					std::lock_guard<std::mutex> lock(requestMutex);
+#endif
+
+					RequestTable::Entry *entry = pendingRequests.find(response.getRequestId());
+
+					if (entry == nullptr ||
+						(entry->receiverMac != EventPacket::NULL_MAC && entry->receiverMac != response.getTransmitterMac()))
+					{
+						OSSHS_LOG_DEBUG("Discarding response to no pending request(requestId = %u).", response.getRequestId());
+						return;
+					}
+
+					callback = entry->callback;
+					pendingRequests.release(*entry);
+				}
+
+				// Invoked without the request table locked, so callbacks may send requests of their own.
+				if (callback != nullptr)
+				{
+					callback(RequestStatus::COMPLETED, response.getEvent());
+				}
+			}
+
+			void
+			InterfaceManager::expireRequests()
+			{
+				while (true)
+				{
+					std::shared_ptr<events::Event> command;
+					ResponseCallback callback;
+					uint32_t receiverMac;
+					uint16_t requestId;
+
+					{
+#if OSSHS_PROTOCOL_THREADED
+						std::lock_guard<std::mutex> lock(requestMutex);
+#endif
+
+						RequestTable::Entry *entry = pendingRequests.findExpired();
+
+						if (entry == nullptr)
+							return;
+
+						if (entry->retries > 0)
+						{
+							entry->retries--;
+							entry->sent = modm::Clock::now();
+
+							command = entry->command;
+							receiverMac = entry->receiverMac;
+							requestId = entry->requestId;
+						}
+						else
+						{
+							callback = entry->callback;
+							pendingRequests.release(*entry);
+						}
+					}
+
+					if (command != nullptr)
+					{
+						PacketRef eventPacket = EventPacket::make(command, mac, receiverMac, true, requestId);
+
+						// Without memory for the retry, the request waits for another timeout.
+						if (eventPacket != nullptr && !eventPacket->isMalformed())
+							transmit(eventPacket);
+
+						continue;
+					}
+
+#if OSSHS_PROTOCOL_THREADED
+					std::lock_guard<std::mutex> lock(sinkMutex);
+#endif
+
+					if (callback != nullptr)
+					{
+						callback(RequestStatus::TIMED_OUT, nullptr);
+					}
+				}
+			}
+
+			void
+			InterfaceManager::publishStatistics()
+			{
+				for (std::size_t i = 0; i < interfaces.size(); i++)
+				{
+					statisticsCallback(i, interfaces[i]->getStatistics());
 				}
 			}
 		}
@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/interfaces/packet_buffer.hpp>
+#include <osshs/protocol/memory/slab_allocator.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			PacketBuffer::~PacketBuffer()
+			{
+				release();
+			}
+
+			bool
+			PacketBuffer::allocate(uint16_t length)
+			{
+				release();
+
+				data = static_cast<uint8_t *>(memory::SlabAllocator::allocate(length));
+
+				if (data == nullptr)
+					return false;
+
+				this->length = length;
+				return true;
+			}
+
+			bool
+			PacketBuffer::serialize(const EventPacket &eventPacket)
+			{
+				release();
+
+				length = eventPacket.serialize(&PacketBuffer::provide, this);
+
+				if (length == 0)
+					release();
+
+				return length != 0;
+			}
+
+			bool
+			PacketBuffer::serializeContainer(const EventPacket &eventPacket, const std::unique_ptr<const uint8_t[]> *events, uint8_t eventCount)
+			{
+				release();
+
+				length = eventPacket.serializeContainer(events, eventCount, &PacketBuffer::provide, this);
+
+				if (length == 0)
+					release();
+
+				return length != 0;
+			}
+
+			uint8_t *
+			PacketBuffer::provide(void *context, uint16_t packetLength)
+			{
+				PacketBuffer &buffer = *static_cast<PacketBuffer *>(context);
+
+				if (!buffer.allocate(packetLength))
+					return nullptr;
+
+				return buffer.data;
+			}
+
+			void
+			PacketBuffer::release()
+			{
+				memory::SlabAllocator::deallocate(data);
+				data = nullptr;
+				length = 0;
+			}
+
+			uint8_t *
+			PacketBuffer::getWritable()
+			{
+				return data;
+			}
+
+			const uint8_t *
+			PacketBuffer::get() const
+			{
+				return data;
+			}
+
+			uint16_t
+			PacketBuffer::getLength() const
+			{
+				return length;
+			}
+		}
+	}
+}
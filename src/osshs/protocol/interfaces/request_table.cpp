@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/interfaces/request_table.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			uint16_t
+			RequestTable::add(std::shared_ptr<events::Event> command, uint32_t receiverMac, ResponseCallback callback,
+				std::chrono::milliseconds timeout, uint8_t retries)
+			{
+				Entry *free = nullptr;
+
+				for (Entry &entry : entries)
+				{
+					if (entry.requestId == PacketHeader::NO_REQUEST_ID)
+					{
+						free = &entry;
+						break;
+					}
+				}
+
+				if (free == nullptr)
+					return PacketHeader::NO_REQUEST_ID;
+
+				// Ids count up, so a late response to an expired request rarely meets a new request of the same id.
+				do
+				{
+					lastRequestId++;
+				}
+				while (lastRequestId == PacketHeader::NO_REQUEST_ID || find(lastRequestId) != nullptr);
+
+				free->command = std::move(command);
+				free->callback = callback;
+				free->sent = modm::Clock::now();
+				free->timeout = timeout;
+				free->receiverMac = receiverMac;
+				free->requestId = lastRequestId;
+				free->retries = retries;
+				count++;
+
+				return lastRequestId;
+			}
+
+			RequestTable::Entry *
+			RequestTable::find(uint16_t requestId)
+			{
+				if (requestId == PacketHeader::NO_REQUEST_ID)
+					return nullptr;
+
+				for (Entry &entry : entries)
+				{
+					if (entry.requestId == requestId)
+						return &entry;
+				}
+
+				return nullptr;
+			}
+
+			RequestTable::Entry *
+			RequestTable::findExpired()
+			{
+				if (count == 0)
+					return nullptr;
+
+				modm::Clock::time_point now = modm::Clock::now();
+
+				for (Entry &entry : entries)
+				{
+					if (entry.requestId != PacketHeader::NO_REQUEST_ID && (now - entry.sent) > entry.timeout)
+						return &entry;
+				}
+
+				return nullptr;
+			}
+
+			void
+			RequestTable::release(Entry &entry)
+			{
+				entry.command.reset();
+				entry.callback = nullptr;
+				entry.requestId = PacketHeader::NO_REQUEST_ID;
+				count--;
+			}
+
+			bool
+			RequestTable::empty() const
+			{
+				return count == 0;
+			}
+		}
+	}
+}
@@ -0,0 +1,161 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/interfaces/token_bucket.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace interfaces
+		{
+			void
+			TokenBucket::configure(uint32_t bytesPerSecond, uint32_t burstBytes)
+			{
+				rate = bytesPerSecond;
+				capacity = static_cast<int64_t>(burstBytes) * 1000;
+				tokens = capacity;
+				lastRefill = modm::Clock::now();
+			}
+
+			bool
+			TokenBucket::isLimited() const
+			{
+				return rate != 0;
+			}
+
+			bool
+			TokenBucket::isConforming() const
+			{
+				if (rate == 0 || tokens >= 0)
+					return true;
+
+				uint64_t elapsed = (modm::Clock::now() - lastRefill).count();
+				return static_cast<int64_t>(elapsed * rate) >= -tokens;
+			}
+
+			void
+			TokenBucket::consume(uint32_t bytes)
+			{
+				if (rate == 0)
+					return;
+
+				refill();
+				tokens -= static_cast<int64_t>(bytes) * 1000;
+			}
+
+			bool
+			TokenBucket::tryConsume(uint32_t bytes)
+			{
+				if (rate == 0)
+					return true;
+
+				refill();
+
+				if (tokens < 0)
+					return false;
+
+				tokens -= static_cast<int64_t>(bytes) * 1000;
+				return true;
+			}
+
+			void
+			TokenBucket::drain()
+			{
+				tokens = 0;
+				lastRefill = modm::Clock::now();
+			}
+
+			void
+			TokenBucket::refill()
+			{
+				modm::Clock::time_point now = modm::Clock::now();
+				uint64_t elapsed = (now - lastRefill).count();
+				lastRefill = now;
+
+				// Saturate before multiplying, a long idle period would otherwise overflow the product.
+				if (elapsed >= static_cast<uint64_t>(capacity - tokens) / rate)
+					tokens = capacity;
+				else
+					tokens += elapsed * rate;
+			}
+
+			void
+			SourceRateLimiter::configure(uint32_t bytesPerSecond, uint32_t burstBytes)
+			{
+				this->bytesPerSecond = bytesPerSecond;
+				this->burstBytes = burstBytes;
+
+				for (Source &source : sources)
+					source.used = false;
+
+				seenCount = 0;
+			}
+
+			bool
+			SourceRateLimiter::tryConsume(uint32_t sourceMac, uint32_t bytes, bool &evicted)
+			{
+				evicted = false;
+
+				if (bytesPerSecond == 0)
+					return true;
+
+				seenCount++;
+
+				Source *free = nullptr;
+				Source *leastRecent = &sources[0];
+
+				for (Source &source : sources)
+				{
+					if (source.used && source.mac == sourceMac)
+					{
+						source.lastSeen = seenCount;
+						return source.bucket.tryConsume(bytes);
+					}
+
+					if (!source.used && free == nullptr)
+						free = &source;
+
+					// Compared as a difference, so the order survives seenCount wrapping around.
+					if (static_cast<int32_t>(source.lastSeen - leastRecent->lastSeen) < 0)
+						leastRecent = &source;
+				}
+
+				if (free == nullptr)
+				{
+					free = leastRecent;
+					evicted = true;
+				}
+
+				free->mac = sourceMac;
+				free->lastSeen = seenCount;
+				free->used = true;
+				free->bucket.configure(bytesPerSecond, burstBytes);
+				free->bucket.drain();
+
+				return free->bucket.tryConsume(bytes);
+			}
+		}
+	}
+}
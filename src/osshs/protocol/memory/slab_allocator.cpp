@@ -0,0 +1,193 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <new>
+#include <mutex>
+#include <osshs/protocol/memory/slab_allocator.hpp>
+#include <osshs/protocol/memory/fixed_pool.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace memory
+		{
+			static FixedPool<16, OSSHS_PROTOCOL_SLAB_16_COUNT> slab16;
+			static FixedPool<32, OSSHS_PROTOCOL_SLAB_32_COUNT> slab32;
+			static FixedPool<64, OSSHS_PROTOCOL_SLAB_64_COUNT> slab64;
+			static FixedPool<256, OSSHS_PROTOCOL_SLAB_256_COUNT> slab256;
+			static FixedPool<1024, OSSHS_PROTOCOL_SLAB_1024_COUNT> slab1024;
+
+			static SlabStatistics slabStatistics[SlabAllocator::SIZE_CLASS_COUNT];
+
+#if OSSHS_PROTOCOL_THREADED
+			typedef std::mutex SlabMutex;
+#else
+			struct SlabMutex
+			{
+				void
+				lock()
+				{
+				}
+
+				void
+				unlock()
+				{
+				}
+			};
+#endif
+
+			// Every size class is locked on its own, so threads allocating different sizes never contend.
+			static SlabMutex slabMutexes[SlabAllocator::SIZE_CLASS_COUNT];
+
+			template<typename Pool>
+			static void *
+			allocateFrom(Pool &pool, uint8_t sizeClass)
+			{
+				std::lock_guard<SlabMutex> lock(slabMutexes[sizeClass]);
+				SlabStatistics &statistics = slabStatistics[sizeClass];
+
+				void *pointer = pool.allocate();
+
+				if (pointer == nullptr)
+				{
+					statistics.failures++;
+					return nullptr;
+				}
+
+				statistics.allocations++;
+				statistics.blocksInUse++;
+
+				if (statistics.blocksInUse > statistics.highWaterMark)
+					statistics.highWaterMark = statistics.blocksInUse;
+
+				return pointer;
+			}
+
+			template<typename Pool>
+			static bool
+			deallocateTo(Pool &pool, uint8_t sizeClass, void *pointer)
+			{
+				if (!pool.owns(pointer))
+					return false;
+
+				std::lock_guard<SlabMutex> lock(slabMutexes[sizeClass]);
+
+				pool.deallocate(pointer);
+				slabStatistics[sizeClass].blocksInUse--;
+
+				return true;
+			}
+
+			void *
+			SlabAllocator::allocate(std::size_t size)
+			{
+				void *pointer = nullptr;
+
+				if (size <= 16)
+					pointer = allocateFrom(slab16, 0);
+				else if (size <= 32)
+					pointer = allocateFrom(slab32, 1);
+				else if (size <= 64)
+					pointer = allocateFrom(slab64, 2);
+				else if (size <= 256)
+					pointer = allocateFrom(slab256, 3);
+				else if (size <= 1024)
+					pointer = allocateFrom(slab1024, 4);
+				else
+				{
+					std::lock_guard<SlabMutex> lock(slabMutexes[4]);
+					slabStatistics[4].failures++;
+				}
+
+#if !OSSHS_PROTOCOL_STATIC_MEMORY
+				if (pointer == nullptr)
+					pointer = ::operator new(size, std::nothrow);
+#endif
+
+				return pointer;
+			}
+
+			void
+			SlabAllocator::deallocate(void *pointer)
+			{
+				if (pointer == nullptr)
+					return;
+
+				if (deallocateTo(slab16, 0, pointer) ||
+					deallocateTo(slab32, 1, pointer) ||
+					deallocateTo(slab64, 2, pointer) ||
+					deallocateTo(slab256, 3, pointer) ||
+					deallocateTo(slab1024, 4, pointer))
+				{
+					return;
+				}
+
+#if !OSSHS_PROTOCOL_STATIC_MEMORY
+				::operator delete(pointer);
+#endif
+			}
+
+			bool
+			SlabAllocator::getStatistics(uint8_t sizeClass, SlabStatistics &statistics)
+			{
+				static constexpr uint32_t blockSizes[SIZE_CLASS_COUNT] = {16, 32, 64, 256, 1024};
+				static constexpr uint32_t blockCounts[SIZE_CLASS_COUNT] = {
+					OSSHS_PROTOCOL_SLAB_16_COUNT,
+					OSSHS_PROTOCOL_SLAB_32_COUNT,
+					OSSHS_PROTOCOL_SLAB_64_COUNT,
+					OSSHS_PROTOCOL_SLAB_256_COUNT,
+					OSSHS_PROTOCOL_SLAB_1024_COUNT
+				};
+
+				if (sizeClass >= SIZE_CLASS_COUNT)
+					return false;
+
+				{
+					std::lock_guard<SlabMutex> lock(slabMutexes[sizeClass]);
+					statistics = slabStatistics[sizeClass];
+				}
+
+				statistics.blockSize = blockSizes[sizeClass];
+				statistics.blockCount = blockCounts[sizeClass];
+
+				return true;
+			}
+
+			void
+			SlabAllocator::resetStatistics()
+			{
+				for (uint8_t sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; sizeClass++)
+				{
+					std::lock_guard<SlabMutex> lock(slabMutexes[sizeClass]);
+					SlabStatistics &statistics = slabStatistics[sizeClass];
+
+					statistics.allocations = 0;
+					statistics.failures = 0;
+					statistics.highWaterMark = statistics.blocksInUse;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,202 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <osshs/protocol/utility/lz_codec.hpp>
+
+namespace osshs
+{
+	namespace protocol
+	{
+		namespace utility
+		{
+			namespace
+			{
+				class BitWriter
+				{
+				public:
+					BitWriter(uint8_t *data, uint16_t capacity)
+						: data(data), capacity(capacity)
+					{
+					}
+
+					bool
+					write(uint16_t value, uint8_t bitCount)
+					{
+						while (bitCount-- > 0)
+						{
+							if (bitOffset == 0)
+							{
+								if (length == capacity)
+									return false;
+
+								data[length++] = 0;
+							}
+
+							if ((value >> bitCount) & 0b1)
+								data[length - 1] |= 0x80 >> bitOffset;
+
+							bitOffset = (bitOffset + 1) & 0b111;
+						}
+
+						return true;
+					}
+
+					uint16_t
+					getLength() const
+					{
+						return length;
+					}
+				private:
+					uint8_t *data;
+					uint16_t capacity;
+					uint16_t length = 0;
+					uint8_t bitOffset = 0;
+				};
+
+				class BitReader
+				{
+				public:
+					BitReader(const uint8_t *data, uint16_t length)
+						: data(data), remainingBits(static_cast<uint32_t>(length) * 8)
+					{
+					}
+
+					bool
+					read(uint16_t &value, uint8_t bitCount)
+					{
+						if (remainingBits < bitCount)
+							return false;
+
+						value = 0;
+						remainingBits -= bitCount;
+
+						while (bitCount-- > 0)
+						{
+							value = (value << 1) | ((data[position >> 3] >> (7 - (position & 0b111))) & 0b1);
+							position++;
+						}
+
+						return true;
+					}
+				private:
+					const uint8_t *data;
+					uint32_t remainingBits;
+					uint32_t position = 0;
+				};
+			}
+
+			uint16_t
+			LzCodec::compress(const uint8_t *input, uint16_t inputLength, uint8_t *output, uint16_t outputCapacity)
+			{
+				BitWriter writer(output, outputCapacity);
+
+				for (uint16_t position = 0; position < inputLength;)
+				{
+					uint16_t maxLength = inputLength - position < MAX_MATCH ? inputLength - position : MAX_MATCH;
+					uint16_t bestLength = 0;
+					uint16_t bestDistance = 0;
+
+					for (uint16_t distance = 1; distance <= WINDOW_SIZE && distance <= position; distance++)
+					{
+						const uint8_t *candidate = &input[position - distance];
+
+						// Matches may run into the bytes they reproduce, which encodes repeated patterns cheaply.
+						uint16_t length = 0;
+						while (length < maxLength && candidate[length] == input[position + length])
+							length++;
+
+						if (length > bestLength)
+						{
+							bestLength = length;
+							bestDistance = distance;
+
+							if (length == maxLength)
+								break;
+						}
+					}
+
+					if (bestLength >= MIN_MATCH)
+					{
+						if (!writer.write(0, 1) ||
+							!writer.write(bestDistance - 1, WINDOW_BITS) ||
+							!writer.write(bestLength - MIN_MATCH, LENGTH_BITS))
+							return 0;
+
+						position += bestLength;
+					}
+					else
+					{
+						if (!writer.write((0b1 << 8) | input[position], 9))
+							return 0;
+
+						position++;
+					}
+				}
+
+				return writer.getLength();
+			}
+
+			bool
+			LzCodec::decompress(const uint8_t *input, uint16_t inputLength, uint8_t *output, uint16_t outputLength)
+			{
+				BitReader reader(input, inputLength);
+
+				for (uint16_t position = 0; position < outputLength;)
+				{
+					uint16_t isLiteral;
+					if (!reader.read(isLiteral, 1))
+						return false;
+
+					if (isLiteral)
+					{
+						uint16_t literal;
+						if (!reader.read(literal, 8))
+							return false;
+
+						output[position++] = literal;
+						continue;
+					}
+
+					uint16_t distance;
+					uint16_t length;
+					if (!reader.read(distance, WINDOW_BITS) || !reader.read(length, LENGTH_BITS))
+						return false;
+
+					distance += 1;
+					length += MIN_MATCH;
+
+					if (distance > position || length > outputLength - position)
+						return false;
+
+					for (; length > 0; length--, position++)
+					{
+						output[position] = output[position - distance];
+					}
+				}
+
+				return true;
+			}
+		}
+	}
+}
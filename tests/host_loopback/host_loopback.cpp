@@ -0,0 +1,444 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*
+ * Host port and end-to-end test over socketpair() stand-ins for CAN buses and serial ports.
+ * Usage: host_loopback
+ * Exchanges frames between two SocketCanPorts over a sequenced packet socketpair and bytes between two SerialPorts over
+ * a stream socketpair. Then bridges a request and its response between a CAN node and a USART node through an
+ * interface manager with one interface of either kind, and checks that a crafted USART frame longer than the MTU is
+ * dropped as malformed. Finally sends unicast and multicast events to the same receiver and checks that they arrive in
+ * order, which is only at stake when built with OSSHS_PROTOCOL_CONTAINER_EVENTS above one. Exits with a non-zero status
+ * if any check fails.
+ * Build as described in docs/HOST.md.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <osshs/events/event_factory.hpp>
+#include <osshs/protocol/utility/bit_field.hpp>
+#include <osshs/protocol/interfaces/interface_manager.hpp>
+#include <osshs/protocol/interfaces/can/can_interface.hpp>
+#include <osshs/protocol/interfaces/usart/usart_interface.hpp>
+#include <osshs/protocol/interfaces/host/socket_can.hpp>
+#include <osshs/protocol/interfaces/host/serial_port.hpp>
+
+using osshs::protocol::interfaces::Backpressure;
+using osshs::protocol::interfaces::EventPacket;
+using osshs::protocol::interfaces::InterfaceManager;
+using osshs::protocol::interfaces::InterfaceStatistics;
+using osshs::protocol::interfaces::PacketRef;
+using osshs::protocol::interfaces::Request;
+using osshs::protocol::interfaces::RequestHandle;
+using osshs::protocol::interfaces::RequestStatus;
+using osshs::protocol::interfaces::can::CanInterface;
+using osshs::protocol::interfaces::usart::UsartHeader;
+using osshs::protocol::interfaces::usart::UsartInterface;
+using osshs::protocol::interfaces::host::HostSerial;
+using osshs::protocol::interfaces::host::SerialPort;
+using osshs::protocol::interfaces::host::SocketCan;
+using osshs::protocol::interfaces::host::SocketCanPort;
+using osshs::protocol::utility::ByteField;
+
+static constexpr uint16_t REQUEST_TYPE = 0x0001;
+static constexpr uint16_t RESPONSE_TYPE = 0x0002;
+static constexpr uint16_t EVENT_LENGTH = 300;  // Takes several USART and many CAN frames.
+static constexpr uint32_t CAN_NODE_MAC = 1;
+static constexpr uint32_t BRIDGE_MAC = 2;
+static constexpr uint32_t USART_NODE_MAC = 3;
+static constexpr uint32_t MAX_STEPS = 100000;
+static constexpr uint32_t DRAIN_STEPS = 100;  // Enough for an interface to read everything sent to it.
+static constexpr uint16_t ORDER_EVENT_LENGTH = 8;  // Small enough for several to share a container packet.
+static constexpr uint8_t ORDER_EVENT_COUNT = 6;
+
+typedef ByteField<0, 2> EventLength;
+typedef ByteField<2, 2> EventType;
+
+static CanInterface<SocketCan<0>> canNodeInterface;
+static CanInterface<SocketCan<1>> bridgeCanInterface;
+static UsartInterface<HostSerial<0>> bridgeUsartInterface;
+static UsartInterface<HostSerial<1>> usartNodeInterface;
+static InterfaceManager canNode;
+static InterfaceManager bridge;
+static InterfaceManager usartNode;
+
+static uint16_t orderedTypes[ORDER_EVENT_COUNT];
+static uint8_t orderedCount = 0;
+static RequestStatus responseStatus;
+static std::shared_ptr<osshs::events::Event> response;
+static bool responded = false;
+static uint32_t failures = 0;
+
+static void
+expect(bool condition, const char *description)
+{
+	if (condition)
+		return;
+
+	std::fprintf(stderr, "FAILED: %s\n", description);
+	failures++;
+}
+
+static std::shared_ptr<osshs::events::Event>
+makeEvent(uint16_t type, uint8_t seed, uint16_t length = EVENT_LENGTH)
+{
+	std::unique_ptr<uint8_t[]> data(new uint8_t[length]);
+
+	for (uint16_t i = 0; i < length; i++)
+	{
+		data[i] = seed + i * 7;
+	}
+
+	EventLength::write(data.get(), length);
+	EventType::write(data.get(), type);
+
+	return osshs::events::EventFactory::make(type, std::unique_ptr<const uint8_t[]>(data.release()));
+}
+
+static bool
+isEvent(const std::shared_ptr<osshs::events::Event> &event, uint16_t type, uint8_t seed)
+{
+	if (event == nullptr)
+		return false;
+
+	std::unique_ptr<const uint8_t[]> data = event->serialize();
+	std::shared_ptr<osshs::events::Event> expected = makeEvent(type, seed);
+	std::unique_ptr<const uint8_t[]> expectedData = expected->serialize();
+
+	return data != nullptr && EventLength::read(data.get()) == EVENT_LENGTH &&
+		std::memcmp(data.get(), expectedData.get(), EVENT_LENGTH) == 0;
+}
+
+static void
+testSocketCanPort()
+{
+	int fileDescriptors[2];
+
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fileDescriptors) < 0)
+	{
+		expect(false, "socketpair(SOCK_SEQPACKET)");
+		return;
+	}
+
+	SocketCanPort transmitter;
+	SocketCanPort receiver;
+	expect(transmitter.open(fileDescriptors[0]) && receiver.open(fileDescriptors[1]), "SocketCanPort::open()");
+
+	// More frames than fit a batch, so sending has to flush in between.
+	constexpr uint16_t FRAME_COUNT = 3 * SocketCanPort::BATCH_SIZE + 1;
+
+	for (uint16_t i = 0; i < FRAME_COUNT; i++)
+	{
+		modm::can::Message frame(0x1000 + i, i % 9);
+		std::memset(frame.data, i, sizeof(frame.data));
+
+		expect(transmitter.isReadyToSend() && transmitter.sendMessage(frame), "SocketCanPort::sendMessage()");
+	}
+
+	expect(transmitter.flush() && !transmitter.hasPendingTransmissions(), "SocketCanPort::flush()");
+
+	uint16_t received = 0;
+	modm::can::Message frame;
+
+	while (receiver.getMessage(frame))
+	{
+		bool matches = frame.getIdentifier() == 0x1000u + received && frame.getLength() == received % 9 &&
+			frame.isExtended();
+
+		for (uint8_t i = 0; i < frame.getLength(); i++)
+		{
+			matches &= frame.data[i] == static_cast<uint8_t>(received);
+		}
+
+		expect(matches, "SocketCanPort frames arrive intact and in order");
+		received++;
+	}
+
+	expect(received == FRAME_COUNT, "SocketCanPort receives every frame");
+}
+
+static void
+testSerialPort()
+{
+	int fileDescriptors[2];
+
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fileDescriptors) < 0)
+	{
+		expect(false, "socketpair(SOCK_STREAM)");
+		return;
+	}
+
+	SerialPort transmitter;
+	SerialPort receiver;
+	expect(transmitter.open(fileDescriptors[0]) && receiver.open(fileDescriptors[1]), "SerialPort::open()");
+
+	// More bytes than fit the transmit buffer, so writing has to flush in between.
+	constexpr uint16_t LENGTH = 3 * SerialPort::BUFFER_SIZE + 1;
+	uint8_t data[LENGTH];
+
+	for (uint16_t i = 0; i < LENGTH; i++)
+	{
+		data[i] = i * 13;
+	}
+
+	uint16_t written = 0;
+	uint16_t read = 0;
+	uint8_t received[LENGTH];
+
+	for (uint32_t step = 0; step < MAX_STEPS && read < LENGTH; step++)
+	{
+		written += transmitter.write(&data[written], LENGTH - written);
+		transmitter.flush();
+		read += receiver.read(&received[read], LENGTH - read);
+	}
+
+	expect(written == LENGTH && !transmitter.hasPendingTransmissions(), "SerialPort writes every byte");
+	expect(read == LENGTH && std::memcmp(data, received, LENGTH) == 0, "SerialPort bytes arrive intact and in order");
+}
+
+static void
+handleRequest(const Request &request)
+{
+	expect(isEvent(request.command, REQUEST_TYPE, 1), "request arrives intact");
+	expect(request.transmitterMac == CAN_NODE_MAC, "request carries the transmitter mac");
+
+	usartNode.respond(request, makeEvent(RESPONSE_TYPE, 2));
+}
+
+static void
+runNodes()
+{
+	// Stands in for the epoll loop of the gateway, signalling every interface and flushing every port.
+	canNodeInterface.signalReady();
+	bridgeCanInterface.signalReady();
+	bridgeUsartInterface.signalReady();
+	usartNodeInterface.signalReady();
+
+	canNode.run();
+	bridge.run();
+	usartNode.run();
+
+	SocketCan<0>::getPort().flush();
+	SocketCan<1>::getPort().flush();
+	HostSerial<0>::getPort().flush();
+	HostSerial<1>::getPort().flush();
+}
+
+static void
+exchangeRequest()
+{
+	responded = false;
+	response = nullptr;
+
+	RequestHandle handle = canNode.sendRequest(
+		makeEvent(REQUEST_TYPE, 1),
+		USART_NODE_MAC,
+		[](RequestStatus status, std::shared_ptr<osshs::events::Event> event)
+		{
+			responseStatus = status;
+			response = event;
+			responded = true;
+		},
+		std::chrono::seconds(5)
+	);
+
+	expect(handle.isValid(), "InterfaceManager::sendRequest()");
+
+	for (uint32_t step = 0; step < MAX_STEPS && !responded; step++)
+	{
+		runNodes();
+	}
+
+	expect(responded && responseStatus == RequestStatus::COMPLETED, "request completes");
+	expect(isEvent(response, RESPONSE_TYPE, 2), "response arrives intact");
+	expect(!canNode.isPending(handle), "completed request is released");
+}
+
+static void
+testRoundTrip()
+{
+	int canDescriptors[2];
+	int serialDescriptors[2];
+
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, canDescriptors) < 0 ||
+		socketpair(AF_UNIX, SOCK_STREAM, 0, serialDescriptors) < 0)
+	{
+		expect(false, "socketpair()");
+		return;
+	}
+
+	expect(SocketCan<0>::getPort().open(canDescriptors[0]) && SocketCan<1>::getPort().open(canDescriptors[1]) &&
+		HostSerial<0>::getPort().open(serialDescriptors[0]) && HostSerial<1>::getPort().open(serialDescriptors[1]),
+		"open()");
+
+	canNode.initialize();
+	canNode.setMac(CAN_NODE_MAC);
+	canNode.registerInterface(&canNodeInterface);
+
+	bridge.initialize();
+	bridge.setMac(BRIDGE_MAC);
+	bridge.registerInterface(&bridgeCanInterface);
+	bridge.registerInterface(&bridgeUsartInterface);
+
+	usartNode.initialize();
+	usartNode.setMac(USART_NODE_MAC);
+	usartNode.registerInterface(&usartNodeInterface);
+	usartNode.setRequestHandler(&handleRequest);
+
+	exchangeRequest();
+}
+
+static bool
+isSameStatistics(const InterfaceStatistics &a, const InterfaceStatistics &b)
+{
+	return a.packetsIn == b.packetsIn && a.packetsOut == b.packetsOut && a.framesIn == b.framesIn &&
+		a.framesOut == b.framesOut && a.bytesIn == b.bytesIn && a.bytesOut == b.bytesOut &&
+		a.malformedDrops == b.malformedDrops && a.allocationFailures == b.allocationFailures &&
+		a.queueHighWaterMark == b.queueHighWaterMark && a.queueDrops == b.queueDrops &&
+		a.queueCoalesced == b.queueCoalesced && a.reassemblyTimeouts == b.reassemblyTimeouts &&
+		a.txMailboxStalls == b.txMailboxStalls && a.unsubscribedDrops == b.unsubscribedDrops &&
+		a.egressThrottled == b.egressThrottled && a.ingressThrottled == b.ingressThrottled &&
+		a.ingressEvictions == b.ingressEvictions &&
+		a.framesForwarded == b.framesForwarded && a.forwardDrops == b.forwardDrops &&
+		a.eventsMerged == b.eventsMerged && a.eventsUnpacked == b.eventsUnpacked;
+}
+
+static void
+testMalformedUsartFrame()
+{
+	InterfaceStatistics expected = usartNodeInterface.getStatistics();
+	expected.malformedDrops++;
+
+	// A LENGTH byte of 0xff claims a frame longer than the MTU. The filler behind it is longer than the MTU too, so a
+	// receiver accepting the frame would write past its frame buffer.
+	uint8_t frame[UsartHeader::IN_BAND_LENGTH + 2 * UsartHeader::MTU] = {
+		UsartHeader::SYNC,
+		UsartHeader::START_FRAME_FLAG,
+		0x00,
+		0xff
+	};
+
+	uint16_t written = 0;
+
+	for (uint32_t step = 0; step < MAX_STEPS && written < sizeof(frame); step++)
+	{
+		written += HostSerial<0>::getPort().write(&frame[written], sizeof(frame) - written);
+		HostSerial<0>::getPort().flush();
+	}
+
+	expect(written == sizeof(frame), "crafted USART frame is written");
+
+	for (uint32_t step = 0; step < DRAIN_STEPS; step++)
+	{
+		usartNodeInterface.signalReady();
+		usartNode.run();
+	}
+
+	expect(isSameStatistics(usartNodeInterface.getStatistics(), expected),
+		"USART frame longer than the MTU only counts as malformed");
+
+	// The receiver state following the frame buffer is intact, so the link still works.
+	exchangeRequest();
+}
+
+static void
+testEventOrder()
+{
+	// Unicast and multicast events to the same receiver, all queued before the CAN node transmits any of them. With
+	// OSSHS_PROTOCOL_CONTAINER_EVENTS above one, the unicast events behind the first multicast one must not be merged
+	// ahead of it.
+	static constexpr uint32_t RECEIVERS[ORDER_EVENT_COUNT] = {
+		USART_NODE_MAC,
+		EventPacket::NULL_MAC,
+		USART_NODE_MAC,
+		USART_NODE_MAC,
+		EventPacket::NULL_MAC,
+		EventPacket::NULL_MAC
+	};
+	static constexpr uint16_t FIRST_TYPE = 0x0010;
+
+	canNode.setEventSink([](std::shared_ptr<osshs::events::Event>) {});
+	bridge.setEventSink([](std::shared_ptr<osshs::events::Event>) {});
+	usartNode.setEventSink(
+		[](std::shared_ptr<osshs::events::Event> event)
+		{
+			std::unique_ptr<const uint8_t[]> data = event->serialize();
+
+			if (orderedCount < ORDER_EVENT_COUNT && data != nullptr)
+				orderedTypes[orderedCount] = EventType::read(data.get());
+
+			orderedCount++;
+		}
+	);
+
+	uint32_t eventsMerged = canNodeInterface.getStatistics().eventsMerged;
+
+	for (uint8_t i = 0; i < ORDER_EVENT_COUNT; i++)
+	{
+		PacketRef eventPacket = EventPacket::make(makeEvent(FIRST_TYPE + i, i, ORDER_EVENT_LENGTH), CAN_NODE_MAC,
+			RECEIVERS[i]);
+
+		expect(eventPacket != nullptr && canNode.reportEventPacket(eventPacket) != Backpressure::OVERLOADED,
+			"InterfaceManager::reportEventPacket()");
+	}
+
+	for (uint32_t step = 0; step < MAX_STEPS && orderedCount < ORDER_EVENT_COUNT; step++)
+	{
+		runNodes();
+	}
+
+	expect(orderedCount == ORDER_EVENT_COUNT, "every event arrives once");
+
+	for (uint8_t i = 0; i < ORDER_EVENT_COUNT && i < orderedCount; i++)
+	{
+		expect(orderedTypes[i] == FIRST_TYPE + i, "events arrive in the order they were sent");
+	}
+
+#if OSSHS_PROTOCOL_CONTAINER_EVENTS > 1
+	expect(canNodeInterface.getStatistics().eventsMerged > eventsMerged, "back to back events are still merged");
+#else
+	expect(canNodeInterface.getStatistics().eventsMerged == eventsMerged, "events are not merged");
+#endif
+}
+
+int
+main()
+{
+	testSocketCanPort();
+	testSerialPort();
+	testRoundTrip();
+	testMalformedUsartFrame();
+	testEventOrder();
+
+	if (failures > 0)
+	{
+		std::fprintf(stderr, "%u checks failed.\n", failures);
+		return 1;
+	}
+
+	std::printf("All checks passed.\n");
+	return 0;
+}
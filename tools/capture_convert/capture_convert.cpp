@@ -0,0 +1,230 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Converts CAN frames of a capture file to other formats.
+ * Usage: capture_convert <capture file> candump
+ *        capture_convert <capture file> pcap <output file>
+ * candump writes a candump log (as of candump -l) to stdout, channels named can0, can1 and so on. pcap writes a
+ * LINKTYPE_CAN_SOCKETCAN capture. Timestamps count from the start of the capture. Records other than CAN frames have
+ * no equivalent in either format and are skipped.
+ * Build as described in docs/HOST.md.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <osshs/protocol/diagnostics/capture.hpp>
+#include <osshs/protocol/interfaces/host/capture_file.hpp>
+
+using osshs::protocol::diagnostics::CaptureRecord;
+using osshs::protocol::diagnostics::CaptureRecordType;
+using osshs::protocol::interfaces::host::CaptureFile;
+
+static constexpr uint32_t PCAP_MAGIC = 0xa1b2c3d4;
+static constexpr uint32_t PCAP_LINKTYPE_CAN_SOCKETCAN = 227;
+static constexpr uint32_t CAN_EFF_FLAG = 0x80000000;
+static constexpr uint8_t CAN_MAX_LENGTH = 8;
+
+struct PcapHeader
+{
+	uint32_t magic;
+	uint16_t versionMajor;
+	uint16_t versionMinor;
+	int32_t timeZone;
+	uint32_t timestampAccuracy;
+	uint32_t snapshotLength;
+	uint32_t linkType;
+};
+
+struct PcapRecordHeader
+{
+	uint32_t seconds;
+	uint32_t microseconds;
+	uint32_t capturedLength;
+	uint32_t originalLength;
+};
+
+/*
+ * SocketCAN struct can_frame as stored by LINKTYPE_CAN_SOCKETCAN, with the identifier in network byte order.
+ */
+struct PcapCanFrame
+{
+	uint8_t identifier[4];
+	uint8_t length;
+	uint8_t reserved[3];
+	uint8_t data[CAN_MAX_LENGTH];
+};
+
+static_assert(sizeof(PcapHeader) == 24 && sizeof(PcapRecordHeader) == 16 && sizeof(PcapCanFrame) == 16,
+	"pcap layouts must not depend on the compiler.");
+
+static uint64_t
+getMicroseconds(const CaptureFile &captureFile, uint64_t ticks)
+{
+	uint32_t frequency = captureFile.getFrequency();
+	return (ticks / frequency) * 1000000 + (ticks % frequency) * 1000000 / frequency;
+}
+
+static bool
+isCanFrame(const CaptureRecord &record)
+{
+	return record.type == CaptureRecordType::CAN_FRAME && record.length <= CAN_MAX_LENGTH;
+}
+
+static int
+writeCandump(const CaptureFile &captureFile)
+{
+	std::size_t offset = captureFile.getFirstOffset();
+	CaptureRecord record;
+	const uint8_t *data;
+	bool started = false;
+	uint64_t firstTimestamp = 0;
+	uint64_t skipped = 0;
+
+	while (captureFile.read(offset, record, data))
+	{
+		if (!isCanFrame(record))
+		{
+			skipped++;
+			continue;
+		}
+
+		if (!started)
+		{
+			started = true;
+			firstTimestamp = record.timestamp;
+		}
+
+		uint64_t microseconds = getMicroseconds(captureFile, record.timestamp - firstTimestamp);
+		bool extended = record.flags & CaptureRecord::FLAG_EXTENDED;
+
+		std::printf(extended ? "(%llu.%06llu) can%u %08X#" : "(%llu.%06llu) can%u %03X#",
+			static_cast<unsigned long long>(microseconds / 1000000),
+			static_cast<unsigned long long>(microseconds % 1000000),
+			record.flags & CaptureRecord::CHANNEL_MASK,
+			record.identifier);
+
+		for (uint16_t i = 0; i < record.length; i++)
+		{
+			std::printf("%02X", data[i]);
+		}
+
+		std::printf("\n");
+	}
+
+	if (skipped > 0)
+		std::fprintf(stderr, "Skipped %llu records that are not CAN frames.\n", static_cast<unsigned long long>(skipped));
+
+	return 0;
+}
+
+static int
+writePcap(const CaptureFile &captureFile, const char *path)
+{
+	std::FILE *file = std::fopen(path, "wb");
+	if (file == nullptr)
+	{
+		std::fprintf(stderr, "Failed to create %s.\n", path);
+		return 1;
+	}
+
+	PcapHeader header = {PCAP_MAGIC, 2, 4, 0, 0, sizeof(PcapCanFrame), PCAP_LINKTYPE_CAN_SOCKETCAN};
+	bool failed = std::fwrite(&header, sizeof(header), 1, file) != 1;
+
+	std::size_t offset = captureFile.getFirstOffset();
+	CaptureRecord record;
+	const uint8_t *data;
+	bool started = false;
+	uint64_t firstTimestamp = 0;
+	uint64_t skipped = 0;
+
+	while (!failed && captureFile.read(offset, record, data))
+	{
+		if (!isCanFrame(record))
+		{
+			skipped++;
+			continue;
+		}
+
+		if (!started)
+		{
+			started = true;
+			firstTimestamp = record.timestamp;
+		}
+
+		uint64_t microseconds = getMicroseconds(captureFile, record.timestamp - firstTimestamp);
+
+		PcapRecordHeader recordHeader;
+		recordHeader.seconds = microseconds / 1000000;
+		recordHeader.microseconds = microseconds % 1000000;
+		recordHeader.capturedLength = sizeof(PcapCanFrame);
+		recordHeader.originalLength = sizeof(PcapCanFrame);
+
+		uint32_t identifier = record.identifier | ((record.flags & CaptureRecord::FLAG_EXTENDED) ? CAN_EFF_FLAG : 0);
+
+		PcapCanFrame frame = {};
+		frame.identifier[0] = identifier >> 24;
+		frame.identifier[1] = identifier >> 16;
+		frame.identifier[2] = identifier >> 8;
+		frame.identifier[3] = identifier;
+		frame.length = record.length;
+		std::memcpy(frame.data, data, record.length);
+
+		failed = std::fwrite(&recordHeader, sizeof(recordHeader), 1, file) != 1 ||
+			std::fwrite(&frame, sizeof(frame), 1, file) != 1;
+	}
+
+	if (std::fclose(file) != 0 || failed)
+	{
+		std::fprintf(stderr, "Failed to write %s.\n", path);
+		return 1;
+	}
+
+	if (skipped > 0)
+		std::fprintf(stderr, "Skipped %llu records that are not CAN frames.\n", static_cast<unsigned long long>(skipped));
+
+	return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+	bool candump = argc == 3 && std::strcmp(argv[2], "candump") == 0;
+	bool pcap = argc == 4 && std::strcmp(argv[2], "pcap") == 0;
+
+	if (!candump && !pcap)
+	{
+		std::fprintf(stderr, "Usage: %s <capture file> candump\n       %s <capture file> pcap <output file>\n", argv[0], argv[0]);
+		return 1;
+	}
+
+	CaptureFile captureFile;
+	if (!captureFile.open(argv[1]))
+	{
+		std::fprintf(stderr, "Failed to open capture file %s.\n", argv[1]);
+		return 1;
+	}
+
+	return candump ? writeCandump(captureFile) : writePcap(captureFile, argv[3]);
+}
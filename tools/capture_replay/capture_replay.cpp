@@ -0,0 +1,111 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Replays a capture file through the protocol layer.
+ * Usage: capture_replay <capture file> [speed]
+ * The capture is injected through a replay interface and forwarded to a virtual interface, which counts what gets
+ * through. A speed of 1 (the default) replays in real time, N replays N times faster and 0 as fast as possible.
+ * Build as described in docs/HOST.md.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <osshs/protocol/interfaces/interface_manager.hpp>
+#include <osshs/protocol/interfaces/host/capture_file.hpp>
+#include <osshs/protocol/interfaces/host/replay_interface.hpp>
+#include <osshs/protocol/interfaces/host/virtual_interface.hpp>
+
+using osshs::protocol::interfaces::DropPolicy;
+using osshs::protocol::interfaces::InterfaceManager;
+using osshs::protocol::interfaces::host::CaptureFile;
+using osshs::protocol::interfaces::host::ReplayInterface;
+using osshs::protocol::interfaces::host::ReplayStatistics;
+using osshs::protocol::interfaces::host::VirtualInterface;
+
+static constexpr uint16_t QUEUE_CAPACITY = 256;
+
+int
+main(int argc, char *argv[])
+{
+	if (argc != 2 && argc != 3)
+	{
+		std::fprintf(stderr, "Usage: %s <capture file> [speed]\n", argv[0]);
+		return 1;
+	}
+
+	CaptureFile captureFile;
+	if (!captureFile.open(argv[1]))
+	{
+		std::fprintf(stderr, "Failed to open capture file %s.\n", argv[1]);
+		return 1;
+	}
+
+	double speed = argc == 3 ? std::strtod(argv[2], nullptr) : 1;
+
+	ReplayInterface replayInterface(captureFile);
+	VirtualInterface sinkInterface;
+
+	// Declared after the interfaces, so that the manager is destroyed first.
+	InterfaceManager manager;
+	manager.setEventSink(nullptr);
+	manager.initialize();
+
+	replayInterface.setSpeed(speed);
+	sinkInterface.configureQueue(QUEUE_CAPACITY, DropPolicy::DROP_NEWEST);
+
+	manager.registerInterface(&replayInterface);
+	manager.registerInterface(&sinkInterface);
+
+	auto start = std::chrono::steady_clock::now();
+
+	while (!replayInterface.isFinished() || !manager.isIdle())
+	{
+		manager.run();
+
+		// Nothing is due yet when replaying at a finite speed.
+		if (manager.isIdle())
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	const ReplayStatistics &statistics = replayInterface.getReplayStatistics();
+	uint64_t delivered = sinkInterface.getTransmittedCount();
+	uint64_t dropped = sinkInterface.getStatistics().queueDrops;
+
+	std::printf("records:      %llu\n", static_cast<unsigned long long>(statistics.records));
+	std::printf("can frames:   %llu\n", static_cast<unsigned long long>(statistics.canFrames));
+	std::printf("packets:      %llu\n", static_cast<unsigned long long>(statistics.eventPackets));
+	std::printf("malformed:    %llu\n", static_cast<unsigned long long>(statistics.malformed));
+	std::printf("delivered:    %llu\n", static_cast<unsigned long long>(delivered));
+	std::printf("dropped:      %llu\n", static_cast<unsigned long long>(dropped));
+	std::printf("elapsed:      %.3f s\n", elapsed.count());
+	std::printf("throughput:   %.0f event packets/s, %.3f MB/s\n",
+		statistics.eventPackets / elapsed.count(), statistics.bytes / elapsed.count() / 1e6);
+
+	return 0;
+}
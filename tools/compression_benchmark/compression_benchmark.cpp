@@ -0,0 +1,265 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Payload compression benchmark.
+ * Usage: compression_benchmark [<event length>,...]
+ * Compresses synthetic event payloads of typical shapes and reports the compression ratio, the CAN and USART frames
+ * the compressed event packet takes compared to the uncompressed one, and the time spent compressing and
+ * decompressing. Use it to pick OSSHS_PROTOCOL_COMPRESSION_THRESHOLD, which should be well above the event lengths
+ * that do not save a single frame. Timings are those of the host, expect microcontrollers to be 10 to 100 times slower.
+ * Build as described in docs/HOST.md.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <osshs/protocol/interfaces/fragmenter.hpp>
+#include <osshs/protocol/interfaces/packet_header.hpp>
+#include <osshs/protocol/interfaces/can/can_header.hpp>
+#include <osshs/protocol/interfaces/can/bus_load_estimator.hpp>
+#include <osshs/protocol/interfaces/usart/usart_header.hpp>
+#include <osshs/protocol/utility/lz_codec.hpp>
+
+using osshs::protocol::interfaces::Fragmenter;
+using osshs::protocol::interfaces::PacketHeader;
+using osshs::protocol::interfaces::can::BusLoadEstimator;
+using osshs::protocol::interfaces::can::ClassicCanHeader;
+using osshs::protocol::interfaces::usart::UsartHeader;
+using osshs::protocol::utility::LzCodec;
+
+typedef Fragmenter<ClassicCanHeader::MTU, ClassicCanHeader> CanFragmenter;
+typedef Fragmenter<UsartHeader::MTU, UsartHeader> UsartFragmenter;
+
+static constexpr uint16_t MAX_EVENT_LENGTH = 1024 - PacketHeader::MULTI_TARGET_LENGTH;
+static constexpr std::chrono::milliseconds MEASUREMENT_TIME = std::chrono::milliseconds(50);
+
+typedef void (*PayloadGenerator)(std::vector<uint8_t> &payload, std::mt19937 &random);
+
+// Key-value status report as text, e.g. a configuration dump or a log line.
+static void
+generateStatus(std::vector<uint8_t> &payload, std::mt19937 &random)
+{
+	static const char *const ROOMS[] = {"kitchen", "hall", "bedroom", "bathroom"};
+	std::string text;
+
+	while (text.size() < payload.size())
+	{
+		char record[64];
+		snprintf(record, sizeof(record), "room=%s;temp=%.1f;humidity=%u;", ROOMS[random() % 4],
+			18.0 + (random() % 80) / 10.0, static_cast<unsigned>(30 + random() % 30));
+		text += record;
+	}
+
+	std::copy(text.begin(), text.begin() + payload.size(), payload.begin());
+}
+
+// Slowly changing 16 bit sensor samples with a little noise.
+static void
+generateSamples(std::vector<uint8_t> &payload, std::mt19937 &random)
+{
+	for (size_t i = 0; i + 1 < payload.size(); i += 2)
+	{
+		uint16_t sample = 2048 + static_cast<int16_t>(std::lround(400 * std::sin(i / 64.0))) + random() % 4;
+		payload[i] = sample;
+		payload[i + 1] = sample >> 8;
+	}
+}
+
+// Table of fixed-size records with sparse fields, e.g. a device list.
+static void
+generateTable(std::vector<uint8_t> &payload, std::mt19937 &random)
+{
+	std::fill(payload.begin(), payload.end(), 0);
+
+	for (size_t i = 0; i < payload.size(); i++)
+	{
+		switch (i % 8)
+		{
+			case 0:
+				payload[i] = i / 8;
+				break;
+			case 1:
+				payload[i] = 0x10;
+				break;
+			case 4:
+				payload[i] = random() % 2;
+				break;
+		}
+	}
+}
+
+// Incompressible data, e.g. encrypted or already compressed payloads.
+static void
+generateRandom(std::vector<uint8_t> &payload, std::mt19937 &random)
+{
+	for (uint8_t &byte : payload)
+		byte = random();
+}
+
+struct Payload
+{
+	const char *name;
+	PayloadGenerator generate;
+};
+
+static const Payload PAYLOADS[] = {
+	{"status", &generateStatus},
+	{"samples", &generateSamples},
+	{"table", &generateTable},
+	{"random", &generateRandom},
+};
+
+static uint32_t
+getCanBits(uint16_t packetLength)
+{
+	uint16_t fragmentCount = CanFragmenter::getFragmentCount(packetLength);
+	uint16_t lastLength = fragmentCount == 1 ? packetLength :
+		packetLength - (fragmentCount - 1) * CanFragmenter::PAYLOAD_LENGTH + ClassicCanHeader::IN_BAND_LENGTH;
+
+	return (fragmentCount - 1) * BusLoadEstimator::getFrameBits(ClassicCanHeader::MTU) +
+		BusLoadEstimator::getFrameBits(ClassicCanHeader::getPaddedLength(lastLength));
+}
+
+template<typename Function>
+static double
+measure(Function function)
+{
+	uint32_t iterations = 0;
+	auto start = std::chrono::steady_clock::now();
+	auto elapsed = std::chrono::steady_clock::duration::zero();
+
+	do
+	{
+		for (uint8_t i = 0; i < 16; i++)
+			function();
+
+		iterations += 16;
+		elapsed = std::chrono::steady_clock::now() - start;
+	}
+	while (elapsed < MEASUREMENT_TIME);
+
+	return std::chrono::duration<double, std::micro>(elapsed).count() / iterations;
+}
+
+int
+main(int argc, char *argv[])
+{
+	std::vector<uint16_t> eventLengths = {16, 32, 64, 128, 256, 512, MAX_EVENT_LENGTH};
+
+	if (argc > 2)
+	{
+		fprintf(stderr, "Usage: %s [<event length>,...]\n", argv[0]);
+		return 1;
+	}
+
+	if (argc == 2)
+	{
+		eventLengths.clear();
+
+		for (char *token = strtok(argv[1], ","); token != nullptr; token = strtok(nullptr, ","))
+		{
+			unsigned long eventLength = strtoul(token, nullptr, 0);
+
+			if (eventLength <= PacketHeader::MIN_EVENT_LENGTH + 1 || eventLength > MAX_EVENT_LENGTH)
+			{
+				fprintf(stderr, "Event lengths must be between %u and %u bytes.\n", PacketHeader::MIN_EVENT_LENGTH + 2, MAX_EVENT_LENGTH);
+				return 1;
+			}
+
+			eventLengths.push_back(eventLength);
+		}
+	}
+
+	std::mt19937 random(1);
+	volatile uint16_t sink = 0;
+
+	printf("Multi target event packets, CAN bits at %u bit/s worth %.0f us each.\n\n", OSSHS_PROTOCOL_CAN_BIT_RATE,
+		1e6 / OSSHS_PROTOCOL_CAN_BIT_RATE);
+	printf("%-8s %6s %6s %6s %9s %9s %11s %10s %10s\n", "payload", "event", "packet", "ratio", "CAN", "USART", "CAN bits",
+		"comp us", "decomp us");
+
+	for (const Payload &payload : PAYLOADS)
+	{
+		for (uint16_t eventLength : eventLengths)
+		{
+			// Event length and type stay uncompressed, like they do in event packets.
+			uint16_t inputLength = eventLength - PacketHeader::MIN_EVENT_LENGTH;
+			std::vector<uint8_t> input(inputLength);
+			std::vector<uint8_t> compressed(inputLength - 1);
+			std::vector<uint8_t> output(inputLength);
+
+			payload.generate(input, random);
+
+			uint16_t compressedLength = LzCodec::compress(input.data(), inputLength, compressed.data(), compressed.size());
+
+			if (compressedLength != 0 && (!LzCodec::decompress(compressed.data(), compressedLength, output.data(), inputLength) ||
+				input != output))
+			{
+				fprintf(stderr, "Round trip failed(payload = %s, eventLength = %u).\n", payload.name, eventLength);
+				return 1;
+			}
+
+			double compressTime = measure([&]() {
+				sink = LzCodec::compress(input.data(), inputLength, compressed.data(), compressed.size());
+			});
+
+			double decompressTime = compressedLength == 0 ? 0 : measure([&]() {
+				sink = LzCodec::decompress(compressed.data(), compressedLength, output.data(), inputLength);
+			});
+
+			// Event packets fall back to the uncompressed event when compression does not save CAN frames.
+			uint16_t packetLength = PacketHeader::MULTI_TARGET_LENGTH + eventLength;
+			uint16_t sentLength = compressedLength == 0 ? packetLength :
+				PacketHeader::MULTI_TARGET_LENGTH + PacketHeader::MIN_EVENT_LENGTH + compressedLength;
+			bool sentCompressed = CanFragmenter::getFragmentCount(sentLength) < CanFragmenter::getFragmentCount(packetLength);
+
+			if (!sentCompressed)
+				sentLength = packetLength;
+
+			char canFrames[16];
+			char usartFrames[16];
+			char canBits[16];
+			snprintf(canFrames, sizeof(canFrames), "%u>%u", CanFragmenter::getFragmentCount(packetLength),
+				CanFragmenter::getFragmentCount(sentLength));
+			snprintf(usartFrames, sizeof(usartFrames), "%u>%u", UsartFragmenter::getFragmentCount(packetLength),
+				UsartFragmenter::getFragmentCount(sentLength));
+			snprintf(canBits, sizeof(canBits), "%u>%u", getCanBits(packetLength), getCanBits(sentLength));
+
+			printf("%-8s %6u %6u %6.2f %9s %9s %11s %10.2f", payload.name, eventLength, sentLength,
+				static_cast<double>(packetLength) / sentLength, canFrames, usartFrames, canBits, compressTime);
+
+			if (!sentCompressed)
+				printf(" %10s\n", "-");
+			else
+				printf(" %10.2f\n", decompressTime);
+		}
+	}
+
+	return 0;
+}
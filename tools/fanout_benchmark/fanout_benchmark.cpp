@@ -0,0 +1,192 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Fan-out throughput benchmark over virtual interfaces.
+ * Usage: fanout_benchmark <interface count> <event packets per interface>
+ * Every interface injects event packets, which are forwarded to all other interfaces. Build with
+ * OSSHS_PROTOCOL_THREADED=1 to step every interface on a worker thread of its own, otherwise all interfaces are
+ * stepped from the main thread, which gives the single-threaded baseline.
+ * Build as described in docs/HOST.md.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <osshs/events/event_factory.hpp>
+#include <osshs/protocol/interfaces/interface_manager.hpp>
+#include <osshs/protocol/interfaces/host/virtual_interface.hpp>
+
+using osshs::protocol::interfaces::Backpressure;
+using osshs::protocol::interfaces::DropPolicy;
+using osshs::protocol::interfaces::EventPacket;
+using osshs::protocol::interfaces::InterfaceManager;
+using osshs::protocol::interfaces::PacketRef;
+using osshs::protocol::interfaces::host::VirtualInterface;
+
+static constexpr uint16_t EVENT_TYPE = 0x0001;
+static constexpr uint16_t QUEUE_CAPACITY = 256;
+static constexpr uint8_t INJECTION_BURST = 16;
+static constexpr std::chrono::seconds TIMEOUT = std::chrono::seconds(60);
+
+class GeneratorInterface : public VirtualInterface
+{
+public:
+	GeneratorInterface(InterfaceManager &manager, std::shared_ptr<osshs::events::Event> event, uint32_t transmitterMac,
+		uint32_t packetCount)
+		: manager(manager), event(event), transmitterMac(transmitterMac), remaining(packetCount)
+	{
+	}
+protected:
+	bool
+	run() override
+	{
+		VirtualInterface::run();
+
+		for (uint8_t i = 0; i < INJECTION_BURST && remaining > 0; i++)
+		{
+			PacketRef eventPacket = EventPacket::make(event, transmitterMac);
+
+			if (eventPacket == nullptr)
+				break;
+
+			remaining--;
+
+			// Like a well-behaved producer, back off while any receiving interface is congested.
+			if (manager.reportEventPacket(std::move(eventPacket), this) != Backpressure::NONE)
+			{
+				std::this_thread::yield();
+				break;
+			}
+		}
+
+		return true;
+	}
+
+	bool
+	isReady() const override
+	{
+		return remaining > 0 || VirtualInterface::isReady();
+	}
+private:
+	InterfaceManager &manager;
+	std::shared_ptr<osshs::events::Event> event;
+	uint32_t transmitterMac;
+	uint32_t remaining;
+};
+
+int
+main(int argc, char *argv[])
+{
+	if (argc != 3)
+	{
+		std::fprintf(stderr, "Usage: %s <interface count> <event packets per interface>\n", argv[0]);
+		return 1;
+	}
+
+	uint32_t interfaceCount = std::strtoul(argv[1], nullptr, 10);
+	uint32_t packetCount = std::strtoul(argv[2], nullptr, 10);
+
+	if (interfaceCount < 2)
+	{
+		std::fprintf(stderr, "At least two interfaces are needed.\n");
+		return 1;
+	}
+
+	uint8_t serializedEvent[4] = {4, 0, EVENT_TYPE & 0xff, EVENT_TYPE >> 8};
+	std::unique_ptr<uint8_t[]> eventData(new uint8_t[sizeof(serializedEvent)]);
+	std::copy(&serializedEvent[0], &serializedEvent[sizeof(serializedEvent)], eventData.get());
+
+	std::shared_ptr<osshs::events::Event> event = osshs::events::EventFactory::make(
+		EVENT_TYPE,
+		std::unique_ptr<const uint8_t[]>(eventData.release())
+	);
+
+	if (event == nullptr)
+	{
+		std::fprintf(stderr, "Failed to create event of type 0x%04x.\n", EVENT_TYPE);
+		return 1;
+	}
+
+	// Declared after the interfaces, so that the manager is destroyed first.
+	std::vector<std::unique_ptr<GeneratorInterface>> interfaces;
+	InterfaceManager manager;
+
+	manager.initialize();
+
+	for (uint32_t i = 0; i < interfaceCount; i++)
+	{
+		interfaces.emplace_back(new GeneratorInterface(manager, event, i + 1, packetCount));
+		interfaces.back()->configureQueue(QUEUE_CAPACITY, DropPolicy::DROP_NEWEST);
+		manager.registerInterface(interfaces.back().get());
+	}
+
+	uint64_t expected = static_cast<uint64_t>(interfaceCount) * packetCount * (interfaceCount - 1);
+	uint64_t transmitted = 0;
+	uint64_t dropped = 0;
+
+	auto start = std::chrono::steady_clock::now();
+
+#if OSSHS_PROTOCOL_THREADED
+	manager.start();
+#endif
+
+	while (transmitted + dropped < expected && std::chrono::steady_clock::now() - start < TIMEOUT)
+	{
+#if OSSHS_PROTOCOL_THREADED
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#else
+		manager.run();
+#endif
+
+		transmitted = 0;
+		dropped = 0;
+
+		// Counters of other threads are only read, a torn snapshot merely delays the end of the run.
+		for (const std::unique_ptr<GeneratorInterface> &interface : interfaces)
+		{
+			transmitted += interface->getTransmittedCount();
+			dropped += interface->getStatistics().queueDrops;
+		}
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+#if OSSHS_PROTOCOL_THREADED
+	manager.stop();
+#endif
+
+	std::printf("interfaces:   %u\n", interfaceCount);
+	std::printf("threaded:     %s\n", OSSHS_PROTOCOL_THREADED ? "yes" : "no");
+	std::printf("transmitted:  %llu of %llu\n", static_cast<unsigned long long>(transmitted), static_cast<unsigned long long>(expected));
+	std::printf("dropped:      %llu\n", static_cast<unsigned long long>(dropped));
+	std::printf("elapsed:      %.3f s\n", elapsed.count());
+	std::printf("throughput:   %.0f event packets/s\n", transmitted / elapsed.count());
+
+	return transmitted + dropped == expected ? 0 : 1;
+}
@@ -0,0 +1,229 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Linux gateway bridging SocketCAN buses and serial ports through a single epoll loop.
+ * Usage: gateway [--can <interface>]... [--serial <device> <baud rate>] [--capture <file>]
+ * Up to two CAN buses and one serial port are supported. With --capture, all traffic is recorded into a capture file,
+ * each interface as a channel of its own, numbered in command line order.
+ * Build as described in docs/HOST.md.
+ */
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <osshs/protocol/interfaces/interface_manager.hpp>
+#include <osshs/protocol/interfaces/can/can_interface.hpp>
+#include <osshs/protocol/interfaces/usart/usart_interface.hpp>
+#include <osshs/protocol/interfaces/host/socket_can.hpp>
+#include <osshs/protocol/interfaces/host/serial_port.hpp>
+#include <osshs/protocol/interfaces/host/capture_file.hpp>
+
+using osshs::protocol::interfaces::Interface;
+using osshs::protocol::interfaces::InterfaceManager;
+using osshs::protocol::interfaces::can::CanInterface;
+using osshs::protocol::interfaces::usart::UsartInterface;
+using osshs::protocol::interfaces::host::CaptureWriter;
+using osshs::protocol::interfaces::host::HostSerial;
+using osshs::protocol::interfaces::host::SerialPort;
+using osshs::protocol::interfaces::host::SocketCan;
+using osshs::protocol::interfaces::host::SocketCanPort;
+
+// Upper bound on the time between two interface steps, so that timeouts and periodic timers keep running.
+static constexpr int POLL_INTERVAL = 10;
+static constexpr int MAX_ENDPOINTS = 3;
+
+struct Endpoint
+{
+	int fileDescriptor;
+	Interface *interface;
+	SocketCanPort *canPort;
+	SerialPort *serialPort;
+	bool waitingForOutput;
+};
+
+static CanInterface<SocketCan<0>> can0;
+static CanInterface<SocketCan<1>> can1;
+static UsartInterface<HostSerial<0>> serial0;
+static InterfaceManager manager;
+static CaptureWriter captureWriter;
+
+static volatile std::sig_atomic_t stopRequested = 0;
+
+static void
+requestStop(int)
+{
+	stopRequested = 1;
+}
+
+static bool
+addEndpoint(int epollDescriptor, Endpoint *endpoints, int &endpointCount, int fileDescriptor, Interface *interface,
+	SocketCanPort *canPort, SerialPort *serialPort)
+{
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.u32 = endpointCount;
+
+	if (epoll_ctl(epollDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event) < 0)
+	{
+		std::perror("epoll_ctl");
+		return false;
+	}
+
+	endpoints[endpointCount++] = {fileDescriptor, interface, canPort, serialPort, false};
+	manager.registerInterface(interface);
+
+	return true;
+}
+
+static void
+flushEndpoint(int epollDescriptor, Endpoint &endpoint, uint32_t index)
+{
+	bool waitingForOutput = endpoint.canPort != nullptr ? !endpoint.canPort->flush() : !endpoint.serialPort->flush();
+
+	if (waitingForOutput == endpoint.waitingForOutput)
+		return;
+
+	// Only wait for the descriptor to drain while data is held back, it is writable nearly all the time otherwise.
+	struct epoll_event event;
+	event.events = waitingForOutput ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+	event.data.u32 = index;
+
+	epoll_ctl(epollDescriptor, EPOLL_CTL_MOD, endpoint.fileDescriptor, &event);
+	endpoint.waitingForOutput = waitingForOutput;
+}
+
+int
+main(int argc, char *argv[])
+{
+	int epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+	if (epollDescriptor < 0)
+	{
+		std::perror("epoll_create1");
+		return 1;
+	}
+
+	manager.initialize();
+
+	Endpoint endpoints[MAX_ENDPOINTS];
+	int endpointCount = 0;
+	int canCount = 0;
+	bool serialOpen = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--can") == 0 && i + 1 < argc && canCount < 2)
+		{
+			SocketCanPort &port = canCount == 0 ? SocketCan<0>::getPort() : SocketCan<1>::getPort();
+			Interface *interface = canCount == 0 ? static_cast<Interface *>(&can0) : static_cast<Interface *>(&can1);
+
+			if (!port.open(argv[++i]) ||
+				!addEndpoint(epollDescriptor, endpoints, endpointCount, port.getFileDescriptor(), interface, &port, nullptr))
+			{
+				std::fprintf(stderr, "Failed to open CAN interface %s.\n", argv[i]);
+				return 1;
+			}
+
+			canCount++;
+		}
+		else if (std::strcmp(argv[i], "--serial") == 0 && i + 2 < argc && !serialOpen)
+		{
+			const char *path = argv[++i];
+			uint32_t baudRate = std::strtoul(argv[++i], nullptr, 10);
+
+			SerialPort &port = HostSerial<0>::getPort();
+
+			if (!port.open(path, baudRate) ||
+				!addEndpoint(epollDescriptor, endpoints, endpointCount, port.getFileDescriptor(), &serial0, nullptr, &port))
+			{
+				std::fprintf(stderr, "Failed to open serial port %s.\n", path);
+				return 1;
+			}
+
+			serialOpen = true;
+		}
+		else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc && !captureWriter.isOpen())
+		{
+			if (!captureWriter.open(argv[++i]))
+			{
+				std::fprintf(stderr, "Failed to create capture file %s.\n", argv[i]);
+				return 1;
+			}
+		}
+		else
+		{
+			std::fprintf(stderr, "Usage: %s [--can <interface>]... [--serial <device> <baud rate>] [--capture <file>]\n",
+				argv[0]);
+			return 1;
+		}
+	}
+
+	if (endpointCount == 0)
+	{
+		std::fprintf(stderr, "No interfaces given.\n");
+		return 1;
+	}
+
+	if (captureWriter.isOpen())
+	{
+		for (int i = 0; i < endpointCount; i++)
+		{
+			endpoints[i].interface->setCaptureCallback(captureWriter.getCallback(i));
+		}
+	}
+
+	std::signal(SIGINT, requestStop);
+	std::signal(SIGTERM, requestStop);
+
+	struct epoll_event events[MAX_ENDPOINTS];
+
+	while (!stopRequested)
+	{
+		int eventCount = epoll_wait(epollDescriptor, events, MAX_ENDPOINTS, manager.isIdle() ? POLL_INTERVAL : 0);
+
+		for (int i = 0; i < eventCount; i++)
+		{
+			Endpoint &endpoint = endpoints[events[i].data.u32];
+
+			if (events[i].events & (EPOLLIN | EPOLLOUT))
+				endpoint.interface->signalReady();
+		}
+
+		manager.run();
+
+		// Frames queued while stepping go out with one system call per bus or serial port.
+		for (int i = 0; i < endpointCount; i++)
+		{
+			flushEndpoint(epollDescriptor, endpoints[i], i);
+		}
+	}
+
+	close(epollDescriptor);
+	captureWriter.close();
+
+	return 0;
+}
@@ -0,0 +1,438 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Synthetic load generator and end-to-end latency harness over a simulated CAN bus.
+ * Usage: load_generator [--nodes <count>] [--senders <count>] [--bit-rate <bits/s>] [--load <fraction> | --rate <events/s>]
+ *                       [--duration <s>] [--sizes <event length>,...] [--unicast <fraction>] [--commands <fraction>]
+ *                       [--queue <capacity>] [--seed <seed>]
+ * Every node is an independent interface manager with a single interface on the shared bus, which runs in virtual time,
+ * so a simulated second takes far less than a second. Senders report events with Poisson arrivals at the given rate,
+ * or at the rate that loads the bus to the given fraction. Event lengths are drawn evenly from the given sizes, unicast
+ * events go to a random other node and commands are sent as command event packets. Latency is measured from reporting
+ * an event on the sending node to its delivery to the event sink of a receiving node.
+ * Build as described in docs/HOST.md.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include <osshs/events/event_factory.hpp>
+#include <osshs/protocol/utility/bit_field.hpp>
+#include <osshs/protocol/interfaces/interface_manager.hpp>
+#include <osshs/protocol/interfaces/packet_header.hpp>
+#include <osshs/protocol/interfaces/can/bus_load_estimator.hpp>
+#include <osshs/protocol/interfaces/host/simulated_bus.hpp>
+
+using osshs::protocol::interfaces::DropPolicy;
+using osshs::protocol::interfaces::EventPacket;
+using osshs::protocol::interfaces::Fragmenter;
+using osshs::protocol::interfaces::InterfaceManager;
+using osshs::protocol::interfaces::InterfaceStatistics;
+using osshs::protocol::interfaces::PacketHeader;
+using osshs::protocol::interfaces::can::BusLoadEstimator;
+using osshs::protocol::interfaces::can::ClassicCanHeader;
+using osshs::protocol::interfaces::host::SimulatedBus;
+using osshs::protocol::interfaces::host::SimulatedBusInterface;
+using osshs::protocol::utility::ByteField;
+
+static constexpr uint16_t EVENT_TYPE = 0x0001;
+static constexpr uint16_t NO_RECEIVER = 0xffff;
+
+// Serialized event of the generator, the fields after the event header identify it at the receiver.
+typedef ByteField<0, 2> EventLength;
+typedef ByteField<2, 2> EventType;
+typedef ByteField<4, 4> Sequence;
+typedef ByteField<8, 4> TimeLow;
+typedef ByteField<12, 4> TimeHigh;
+typedef ByteField<16, 2> Sender;
+typedef ByteField<18, 2> Receiver;
+
+static constexpr uint16_t MIN_EVENT_LENGTH = Receiver::END;
+static constexpr uint16_t MAX_EVENT_LENGTH = 1024 - PacketHeader::SINGLE_TARGET_LENGTH;  // Fits the largest slab block.
+
+struct Configuration
+{
+	uint32_t nodeCount = 10;
+	uint32_t senderCount = 0;  // All nodes unless given.
+	uint32_t bitRate = 125000;
+	double load = 0.5;
+	double rate = 0;           // Derived from load unless given.
+	double duration = 10;
+	std::vector<uint16_t> sizes = {20, 32, 64};
+	double unicast = 0.2;
+	double commands = 0.05;
+	uint32_t queueCapacity = 0;  // Interface default unless given.
+	uint32_t seed = 1;
+};
+
+class Harness
+{
+public:
+	Harness(const Configuration &configuration)
+		: configuration(configuration), bus(configuration.bitRate), random(configuration.seed)
+	{
+		for (uint32_t i = 0; i < configuration.nodeCount; i++)
+		{
+			nodes.emplace_back(new Node(*this, bus, i));
+		}
+	}
+
+	void
+	run();
+
+	void
+	report(double wallSeconds);
+private:
+	struct Node
+	{
+		Node(Harness &harness, SimulatedBus &bus, uint16_t index)
+			: index(index), interface(bus, index + 1)
+		{
+			manager.setEventSink([&harness, this](std::shared_ptr<osshs::events::Event> event)
+			{
+				harness.onEvent(*this, event);
+			});
+			manager.initialize();
+
+			if (harness.configuration.queueCapacity > 0)
+				interface.configureQueue(harness.configuration.queueCapacity, DropPolicy::DROP_NEWEST);
+
+			manager.registerInterface(&interface);
+		}
+
+		uint16_t index;
+		SimulatedBusInterface interface;
+		InterfaceManager manager;  // Declared after the interface, so that it is destroyed first.
+	};
+
+	const Configuration &configuration;
+	SimulatedBus bus;
+	std::vector<std::unique_ptr<Node>> nodes;
+	std::mt19937_64 random;
+
+	uint32_t sequence = 0;
+	uint64_t generated = 0;
+	uint64_t allocationFailures = 0;
+	uint64_t expected = 0;
+	uint64_t delivered = 0;
+	std::vector<uint64_t> latencies;
+
+	void
+	generate();
+
+	void
+	onEvent(Node &node, std::shared_ptr<osshs::events::Event> event);
+};
+
+/**
+ * @brief Get the number of bits a packet occupies on the bus.
+ */
+static uint32_t
+getPacketBits(uint16_t packetLength)
+{
+	std::vector<uint8_t> packet(packetLength);
+	Fragmenter<ClassicCanHeader::MTU, ClassicCanHeader> fragmenter;
+	fragmenter.start(packet.data(), packetLength);
+
+	uint32_t bits = 0;
+	while (fragmenter.hasNext())
+	{
+		uint8_t frame[ClassicCanHeader::MTU];
+		uint32_t identifier;
+
+		bits += BusLoadEstimator::getFrameBits(fragmenter.next(identifier, frame));
+	}
+
+	return bits;
+}
+
+void
+Harness::generate()
+{
+	uint16_t senderIndex = std::uniform_int_distribution<uint32_t>(0, configuration.senderCount - 1)(random);
+	uint16_t length = configuration.sizes[std::uniform_int_distribution<std::size_t>(0, configuration.sizes.size() - 1)(random)];
+	bool unicast = std::bernoulli_distribution(configuration.unicast)(random);
+	bool command = std::bernoulli_distribution(configuration.commands)(random);
+
+	uint16_t receiverIndex = NO_RECEIVER;
+	if (unicast)
+	{
+		// Any node but the sender.
+		receiverIndex = std::uniform_int_distribution<uint32_t>(0, configuration.nodeCount - 2)(random);
+		if (receiverIndex >= senderIndex)
+			receiverIndex++;
+	}
+
+	uint64_t time = bus.getTime();
+
+	std::unique_ptr<uint8_t[]> data(new uint8_t[length]());
+	EventLength::write(data.get(), length);
+	EventType::write(data.get(), EVENT_TYPE);
+	Sequence::write(data.get(), sequence++);
+	TimeLow::write(data.get(), static_cast<uint32_t>(time));
+	TimeHigh::write(data.get(), static_cast<uint32_t>(time >> 32));
+	Sender::write(data.get(), senderIndex);
+	Receiver::write(data.get(), receiverIndex);
+
+	std::shared_ptr<osshs::events::Event> event = osshs::events::EventFactory::make(
+		EVENT_TYPE,
+		std::unique_ptr<const uint8_t[]>(data.release())
+	);
+
+	generated++;
+
+	if (event == nullptr)
+	{
+		allocationFailures++;
+		return;
+	}
+
+	Node &sender = *nodes[senderIndex];
+
+	if (!unicast && !command)
+	{
+		// The way System reports events of a node.
+		sender.manager.reportEvent(event);
+	}
+	else
+	{
+		auto eventPacket = EventPacket::make(
+			event,
+			senderIndex + 1,
+			unicast ? static_cast<uint32_t>(receiverIndex + 1) : EventPacket::NULL_MAC,
+			command
+		);
+
+		if (eventPacket == nullptr)
+		{
+			allocationFailures++;
+			return;
+		}
+
+		sender.manager.reportEventPacket(std::move(eventPacket));
+	}
+
+	expected += unicast ? 1 : configuration.nodeCount - 1;
+}
+
+void
+Harness::onEvent(Node &node, std::shared_ptr<osshs::events::Event> event)
+{
+	std::unique_ptr<const uint8_t[]> data = event->serialize();
+
+	if (data == nullptr || EventLength::read(data.get()) < MIN_EVENT_LENGTH)
+		return;
+
+	uint16_t receiverIndex = Receiver::read(data.get());
+
+	// Managers hand events reported on their own node to the sink as well, and receive unicast events of others.
+	if (Sender::read(data.get()) == node.index || (receiverIndex != NO_RECEIVER && receiverIndex != node.index))
+		return;
+
+	uint64_t time = TimeLow::read(data.get()) | (static_cast<uint64_t>(TimeHigh::read(data.get())) << 32);
+
+	latencies.push_back(bus.getTime() - time);
+	delivered++;
+}
+
+void
+Harness::run()
+{
+	std::exponential_distribution<double> interarrival(configuration.rate);
+
+	uint64_t end = configuration.duration * 1e9;
+	uint64_t nextArrival = interarrival(random) * 1e9;
+
+	while (true)
+	{
+		while (nextArrival <= bus.getTime() && nextArrival < end)
+		{
+			generate();
+			nextArrival += interarrival(random) * 1e9;
+		}
+
+		for (std::unique_ptr<Node> &node : nodes)
+		{
+			if (!node->manager.isIdle())
+				node->manager.run();
+		}
+
+		// Once generation is over, the bus idling means every queue is drained.
+		if (!bus.step(std::min(nextArrival, end)) && bus.getTime() >= end)
+			break;
+	}
+}
+
+void
+Harness::report(double wallSeconds)
+{
+	uint64_t queueDrops = 0;
+	uint32_t queueHighWaterMark = 0;
+
+	for (std::unique_ptr<Node> &node : nodes)
+	{
+		const InterfaceStatistics &statistics = node->interface.getStatistics();
+
+		queueDrops += statistics.queueDrops;
+		queueHighWaterMark = std::max<uint32_t>(queueHighWaterMark, statistics.queueHighWaterMark);
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+
+	auto percentile = [this](double fraction) -> double
+	{
+		if (latencies.empty())
+			return 0;
+
+		std::size_t index = std::min(latencies.size() - 1, static_cast<std::size_t>(fraction * latencies.size()));
+		return latencies[index] / 1e3;
+	};
+
+	std::printf("nodes:        %u (%u sending)\n", configuration.nodeCount, configuration.senderCount);
+	std::printf("offered rate: %.1f events/s\n", configuration.rate);
+	std::printf("bus load:     %.1f %% over %.3f s\n", 100.0 * bus.getBusyTime() / bus.getTime(), bus.getTime() / 1e9);
+	std::printf("frames:       %llu\n", static_cast<unsigned long long>(bus.getFrameCount()));
+	std::printf("events:       %llu (%llu allocation failures)\n",
+		static_cast<unsigned long long>(generated), static_cast<unsigned long long>(allocationFailures));
+	std::printf("deliveries:   %llu of %llu, %llu lost\n", static_cast<unsigned long long>(delivered),
+		static_cast<unsigned long long>(expected), static_cast<unsigned long long>(expected - delivered));
+	std::printf("queue drops:  %llu, high-water mark %u\n", static_cast<unsigned long long>(queueDrops), queueHighWaterMark);
+	std::printf("latency [us]: p50 %.1f, p99 %.1f, p99.9 %.1f, max %.1f\n",
+		percentile(0.5), percentile(0.99), percentile(0.999), latencies.empty() ? 0 : latencies.back() / 1e3);
+	std::printf("simulated in: %.3f s\n", wallSeconds);
+}
+
+static bool
+parseSizes(const char *argument, std::vector<uint16_t> &sizes)
+{
+	sizes.clear();
+
+	for (const char *next = argument; *next != '\0';)
+	{
+		char *end;
+		unsigned long size = std::strtoul(next, &end, 10);
+
+		if (end == next || size < MIN_EVENT_LENGTH || size > MAX_EVENT_LENGTH)
+			return false;
+
+		sizes.push_back(size);
+		next = *end == ',' ? end + 1 : end;
+	}
+
+	return !sizes.empty();
+}
+
+int
+main(int argc, char *argv[])
+{
+	Configuration configuration;
+	bool valid = true;
+
+	for (int i = 1; i < argc && valid; i++)
+	{
+		const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+		valid = value != nullptr;
+
+		if (!valid)
+			break;
+
+		if (std::strcmp(argv[i], "--nodes") == 0)
+			configuration.nodeCount = std::strtoul(value, nullptr, 10);
+		else if (std::strcmp(argv[i], "--senders") == 0)
+			configuration.senderCount = std::strtoul(value, nullptr, 10);
+		else if (std::strcmp(argv[i], "--bit-rate") == 0)
+			configuration.bitRate = std::strtoul(value, nullptr, 10);
+		else if (std::strcmp(argv[i], "--load") == 0)
+			configuration.load = std::strtod(value, nullptr);
+		else if (std::strcmp(argv[i], "--rate") == 0)
+			configuration.rate = std::strtod(value, nullptr);
+		else if (std::strcmp(argv[i], "--duration") == 0)
+			configuration.duration = std::strtod(value, nullptr);
+		else if (std::strcmp(argv[i], "--sizes") == 0)
+			valid = parseSizes(value, configuration.sizes);
+		else if (std::strcmp(argv[i], "--unicast") == 0)
+			configuration.unicast = std::strtod(value, nullptr);
+		else if (std::strcmp(argv[i], "--commands") == 0)
+			configuration.commands = std::strtod(value, nullptr);
+		else if (std::strcmp(argv[i], "--queue") == 0)
+			configuration.queueCapacity = std::strtoul(value, nullptr, 10);
+		else if (std::strcmp(argv[i], "--seed") == 0)
+			configuration.seed = std::strtoul(value, nullptr, 10);
+		else
+			valid = false;
+
+		i++;
+	}
+
+	if (configuration.senderCount == 0 || configuration.senderCount > configuration.nodeCount)
+		configuration.senderCount = configuration.nodeCount;
+
+	valid = valid && configuration.nodeCount >= 2 && configuration.nodeCount < NO_RECEIVER && configuration.bitRate > 0 &&
+		configuration.duration > 0 && configuration.unicast >= 0 && configuration.unicast <= 1 &&
+		configuration.commands >= 0 && configuration.commands <= 1;
+
+	if (!valid)
+	{
+		std::fprintf(stderr, "Usage: %s [--nodes <count>] [--senders <count>] [--bit-rate <bits/s>] "
+			"[--load <fraction> | --rate <events/s>] [--duration <s>] [--sizes <event length>,...] "
+			"[--unicast <fraction>] [--commands <fraction>] [--queue <capacity>] [--seed <seed>]\n", argv[0]);
+		return 1;
+	}
+
+	if (configuration.rate <= 0)
+	{
+		double meanBits = 0;
+
+		for (uint16_t size : configuration.sizes)
+		{
+			meanBits += (1 - configuration.unicast) * getPacketBits(PacketHeader::MULTI_TARGET_LENGTH + size) +
+				configuration.unicast * getPacketBits(PacketHeader::SINGLE_TARGET_LENGTH + size);
+		}
+
+		meanBits /= configuration.sizes.size();
+		configuration.rate = configuration.load * configuration.bitRate / meanBits;
+	}
+
+	if (configuration.rate <= 0)
+	{
+		std::fprintf(stderr, "Rate must be positive.\n");
+		return 1;
+	}
+
+	Harness harness(configuration);
+
+	auto start = std::chrono::steady_clock::now();
+	harness.run();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	harness.report(elapsed.count());
+
+	return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Linas Nikiperavicius
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Host-side decoder for trace dumps produced by osshs::protocol::diagnostics::Trace::dump().
+ * Usage: trace_decoder <dump file>
+ * The dump is expected to come from a target with the same byte order as the host.
+ * Build as described in docs/HOST.md.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <osshs/protocol/diagnostics/trace.hpp>
+
+using osshs::protocol::diagnostics::TraceDumpHeader;
+using osshs::protocol::diagnostics::TraceEventId;
+using osshs::protocol::diagnostics::TraceRecord;
+
+static const char *
+getEventName(TraceEventId eventId)
+{
+	switch (eventId)
+	{
+	case TraceEventId::EVENT_REPORTED:
+		return "EVENT_REPORTED";
+	case TraceEventId::EVENT_PACKET_DISPATCHED:
+		return "EVENT_PACKET_DISPATCHED";
+	case TraceEventId::EVENT_PACKET_ENQUEUED:
+		return "EVENT_PACKET_ENQUEUED";
+	case TraceEventId::CAN_EVENT_PACKET_READ:
+		return "CAN_EVENT_PACKET_READ";
+	case TraceEventId::CAN_EVENT_PACKET_WRITTEN:
+		return "CAN_EVENT_PACKET_WRITTEN";
+	case TraceEventId::USART_EVENT_PACKET_WRITTEN:
+		return "USART_EVENT_PACKET_WRITTEN";
+	case TraceEventId::EVENT_PACKET_MERGED:
+		return "EVENT_PACKET_MERGED";
+	case TraceEventId::USART_EVENT_PACKET_READ:
+		return "USART_EVENT_PACKET_READ";
+	default:
+		return "UNKNOWN";
+	}
+}
+
+int
+main(int argc, char *argv[])
+{
+	if (argc != 2)
+	{
+		std::fprintf(stderr, "Usage: %s <dump file>\n", argv[0]);
+		return 1;
+	}
+
+	std::FILE *file = std::fopen(argv[1], "rb");
+	if (file == nullptr)
+	{
+		std::fprintf(stderr, "Failed to open %s.\n", argv[1]);
+		return 1;
+	}
+
+	TraceDumpHeader header;
+	if (std::fread(&header, sizeof(header), 1, file) != 1 || header.magic != TraceDumpHeader::MAGIC)
+	{
+		std::fprintf(stderr, "Not a trace dump.\n");
+		std::fclose(file);
+		return 1;
+	}
+
+	if (header.version != TraceDumpHeader::VERSION || header.recordSize != sizeof(TraceRecord))
+	{
+		std::fprintf(stderr, "Unsupported trace dump(version = %u, recordSize = %u).\n", header.version, header.recordSize);
+		std::fclose(file);
+		return 1;
+	}
+
+	std::vector<TraceRecord> records(header.recordCount);
+	std::size_t recordCount = std::fread(records.data(), sizeof(TraceRecord), records.size(), file);
+	std::fclose(file);
+
+	if (recordCount != header.recordCount)
+		std::fprintf(stderr, "Trace dump truncated(expected %u records, got %zu).\n", header.recordCount, recordCount);
+
+	double ticksPerMicrosecond = header.frequency / 1e6;
+	uint32_t previousTimestamp = recordCount ? records[0].timestamp : 0;
+	uint64_t elapsedTicks = 0;
+
+	std::printf("%14s %12s  %-26s %-4s %-10s %-10s %-6s %s\n",
+		"time [us]", "delta [us]", "event", "flag", "transmitter", "receiver", "type", "length");
+
+	for (std::size_t i = 0; i < recordCount; i++)
+	{
+		const TraceRecord &record = records[i];
+
+		uint32_t deltaTicks = record.timestamp - previousTimestamp;
+		elapsedTicks += deltaTicks;
+		previousTimestamp = record.timestamp;
+
+		std::printf("%14.3f %12.3f  %-26s %c%c   0x%08x 0x%08x 0x%04x %u\n",
+			elapsedTicks / ticksPerMicrosecond,
+			deltaTicks / ticksPerMicrosecond,
+			getEventName(record.eventId),
+			(record.flags & TraceRecord::FLAG_MULTI_TARGET) ? 'M' : '-',
+			(record.flags & TraceRecord::FLAG_COMMAND) ? 'C' : '-',
+			record.transmitterMac,
+			record.receiverMac,
+			record.eventType,
+			record.length);
+	}
+
+	return 0;
+}